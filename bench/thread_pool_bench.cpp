@@ -0,0 +1,329 @@
+/**
+ * @file thread_pool_bench.cpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief throughput / latency benchmarks of `Eden::ThreadPool`
+ * @version 0.1
+ * @date 2023-02-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Every case runs once per queue mode and thread count, and prints one line
+ * (JSON by default, `--csv` for CSV) with the tasks per second and the
+ * submit-to-start latency percentiles, so that two runs can be diffed.
+ *
+ *   $ xmake build thread_pool_bench
+ *   $ xmake run thread_pool_bench --tasks 100000 --threads 1,4 --only empty
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "TaskGroup.hpp"
+#include "ThreadPool.hpp"
+
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief command line of the benchmark
+struct Config {
+  /// @brief tasks per case (the heavier cases scale it down)
+  std::size_t tasks = 200000;
+  /// @brief thread counts to try (never above `hardware_concurrency()`)
+  std::vector<std::size_t> threads{};
+  /// @brief run only the case with this name (empty => all of them)
+  std::string only{};
+  bool csv = false;
+};
+
+/// @brief submit-to-start latencies, one slot per task
+class Sampler {
+ public:
+  explicit Sampler(std::size_t capacity)
+      : samples(std::make_unique<std::uint64_t[]>(capacity)),
+        capacity(capacity) {}
+
+  /// @brief (at the start of a task) record the time since `enqueuedAt`
+  void record(Clock::time_point enqueuedAt) noexcept {
+    auto waited = Clock::now() - enqueuedAt;
+    auto slot = next.fetch_add(1, std::memory_order_relaxed);
+    if (slot < capacity) [[likely]] {
+      samples[slot] = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(waited)
+              .count());
+    }
+  }
+
+  /// @brief latency below which `ratio` of the samples fall (in ns)
+  std::uint64_t percentile(double ratio) {
+    auto count = std::min(next.load(), capacity);
+    if (count == 0) [[unlikely]] {
+      return 0;
+    }
+    if (!sorted) {
+      std::sort(samples.get(), samples.get() + count);
+      sorted = true;
+    }
+    auto rank = static_cast<std::size_t>(ratio * static_cast<double>(count - 1));
+    return samples[rank];
+  }
+
+ private:
+  std::unique_ptr<std::uint64_t[]> samples;
+  std::size_t capacity;
+  std::atomic<std::size_t> next = 0;
+  bool sorted = false;
+};
+
+/// @brief the CPU-bound body: a (much) longer `fib_seq_test()` sequence
+inline std::uint64_t fib_work(std::size_t length) {
+  std::uint64_t a = 1;
+  std::uint64_t b = 1;
+  for (std::size_t i = 2; i < length; ++i) [[likely]] {
+    auto c = a + b;
+    a = b;
+    b = c;
+  }
+  return b;
+}
+
+/// @brief keeps `fib_work()` from being optimized away
+std::atomic<std::uint64_t> sink = 0;
+
+/**
+ * @brief one load: queues `tasks` tasks on `pool` (recording their
+ *        latency in `sampler`) and returns the number of tasks it ran
+ *
+ */
+using Load = std::size_t (*)(Eden::ThreadPool &pool, Sampler &sampler,
+                             std::size_t tasks);
+
+/// @brief empty tasks from one producer (pure scheduling overhead)
+std::size_t empty_tasks(Eden::ThreadPool &pool, Sampler &sampler,
+                        std::size_t tasks) {
+  for (std::size_t i = 0; i < tasks; ++i) [[likely]] {
+    pool.submit_detached(
+        [&sampler, at = Clock::now()]() { sampler.record(at); });
+  }
+  return tasks;
+}
+
+/// @brief CPU-bound tasks (~2000 dependent additions each)
+std::size_t cpu_bound(Eden::ThreadPool &pool, Sampler &sampler,
+                      std::size_t tasks) {
+  tasks = std::max<std::size_t>(tasks / 10, 1);
+  for (std::size_t i = 0; i < tasks; ++i) [[likely]] {
+    pool.submit_detached([&sampler, i, at = Clock::now()]() {
+      sampler.record(at);
+      sink.fetch_add(fib_work(2000 + i % 64), std::memory_order_relaxed);
+    });
+  }
+  return tasks;
+}
+
+/// @brief roots spawning 16 children each and waiting for them
+std::size_t fan_out_in(Eden::ThreadPool &pool, Sampler &sampler,
+                       std::size_t tasks) {
+  constexpr std::size_t fan_out = 16;
+  auto roots = std::max<std::size_t>(tasks / (fan_out + 1), 1);
+  for (std::size_t i = 0; i < roots; ++i) [[likely]] {
+    pool.submit_detached([&pool, &sampler, at = Clock::now()]() {
+      sampler.record(at);
+      Eden::TaskGroup group{pool};
+      for (std::size_t k = 0; k < fan_out; ++k) [[likely]] {
+        group.spawn([&sampler, at = Clock::now()]() {
+          sampler.record(at);
+          sink.fetch_add(fib_work(64), std::memory_order_relaxed);
+        });
+      }
+      group.wait();
+    });
+  }
+  return roots * (fan_out + 1);
+}
+
+/// @brief many producer threads racing on the queue with empty tasks
+std::size_t producer_heavy(Eden::ThreadPool &pool, Sampler &sampler,
+                           std::size_t tasks) {
+  auto producerNum = std::max<std::size_t>(2 * pool.threads_num(), 4);
+  auto share = tasks / producerNum;
+  std::vector<std::thread> producers{};
+  for (std::size_t p = 0; p < producerNum; ++p) [[likely]] {
+    producers.emplace_back([&pool, &sampler, share]() {
+      for (std::size_t i = 0; i < share; ++i) [[likely]] {
+        pool.submit_detached(
+            [&sampler, at = Clock::now()]() { sampler.record(at); });
+      }
+    });
+  }
+  for (auto &producer : producers) [[likely]] {
+    producer.join();
+  }
+  return share * producerNum;
+}
+
+/// @brief one producer feeding tasks which cost more than their enqueue
+std::size_t consumer_heavy(Eden::ThreadPool &pool, Sampler &sampler,
+                           std::size_t tasks) {
+  tasks = std::max<std::size_t>(tasks / 4, 1);
+  for (std::size_t i = 0; i < tasks; ++i) [[likely]] {
+    pool.submit_detached([&sampler, at = Clock::now()]() {
+      sampler.record(at);
+      sink.fetch_add(fib_work(256), std::memory_order_relaxed);
+    });
+  }
+  return tasks;
+}
+
+struct Case {
+  std::string_view name;
+  Load load;
+};
+
+struct Mode {
+  std::string_view name;
+  bool workStealing;
+  Eden::TaskQueueKind queueKind;
+};
+
+void print_header(const Config &config) {
+  if (config.csv) {
+    std::cout << "case,mode,threads,tasks,seconds,tasks_per_sec,p50_ns,"
+                 "p99_ns,p999_ns\n";
+  }
+}
+
+void run_case(const Config &config, const Case &bench, const Mode &mode,
+              std::size_t threads) {
+  Eden::ThreadPool pool{Eden::ThreadPoolOptions{.numThreads = threads,
+                                                .workStealing = mode.workStealing,
+                                                .queueKind = mode.queueKind}};
+  // warm up (threads started, allocators primed), then measure
+  {
+    Sampler warmup{config.tasks};
+    bench.load(pool, warmup, std::max<std::size_t>(config.tasks / 10, 1));
+    pool.wait_idle();
+  }
+  Sampler sampler{config.tasks};
+  auto begin = Clock::now();
+  auto ran = bench.load(pool, sampler, config.tasks);
+  pool.wait_idle();
+  std::chrono::duration<double> elapsed = Clock::now() - begin;
+  auto perSecond = static_cast<double>(ran) / elapsed.count();
+  auto p50 = sampler.percentile(0.5);
+  auto p99 = sampler.percentile(0.99);
+  auto p999 = sampler.percentile(0.999);
+  if (config.csv) {
+    std::cout << bench.name << ',' << mode.name << ',' << threads << ','
+              << ran << ',' << elapsed.count() << ',' << perSecond << ','
+              << p50 << ',' << p99 << ',' << p999 << '\n';
+  } else {
+    std::cout << R"({"case":")" << bench.name << R"(","mode":")" << mode.name
+              << R"(","threads":)" << threads << R"(,"tasks":)" << ran
+              << R"(,"seconds":)" << elapsed.count() << R"(,"tasks_per_sec":)"
+              << perSecond << R"(,"p50_ns":)" << p50 << R"(,"p99_ns":)" << p99
+              << R"(,"p999_ns":)" << p999 << "}\n";
+  }
+  std::cout.flush();
+}
+
+/// @brief parse `1,2,4` (dropping counts above the hardware)
+std::vector<std::size_t> parse_threads(const std::string &list) {
+  std::vector<std::size_t> threads{};
+  std::istringstream iss{list};
+  std::string item{};
+  auto hardware = std::max(1U, std::thread::hardware_concurrency());
+  while (std::getline(iss, item, ',')) [[likely]] {
+    auto count = std::strtoul(item.c_str(), nullptr, 10);
+    if (count > 0 && count <= hardware) {
+      threads.emplace_back(count);
+    }
+  }
+  return threads;
+}
+
+/// @brief 1, 2, 4, ... up to (and including) `hardware_concurrency()`
+std::vector<std::size_t> default_threads() {
+  std::vector<std::size_t> threads{};
+  auto hardware = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  for (std::size_t count = 1; count < hardware; count *= 2) [[likely]] {
+    threads.emplace_back(count);
+  }
+  threads.emplace_back(hardware);
+  return threads;
+}
+
+Config parse_args(int argc, char **argv) {
+  Config config{};
+  for (int i = 1; i < argc; ++i) [[likely]] {
+    std::string_view arg{argv[i]};
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) [[unlikely]] {
+        std::cerr << "missing value after " << arg << "\n";
+        std::exit(2);
+      }
+      return argv[++i];
+    };
+    if (arg == "--tasks") {
+      config.tasks = std::max<std::size_t>(
+          std::strtoull(value().c_str(), nullptr, 10), 1);
+    } else if (arg == "--threads") {
+      config.threads = parse_threads(value());
+    } else if (arg == "--only") {
+      config.only = value();
+    } else if (arg == "--csv") {
+      config.csv = true;
+    } else {
+      std::cerr << "usage: thread_pool_bench [--tasks N] [--threads 1,2,4] "
+                   "[--only CASE] [--csv]\n";
+      std::exit(arg == "--help" ? 0 : 2);
+    }
+  }
+  if (config.threads.empty()) {
+    config.threads = default_threads();
+  }
+  return config;
+}
+
+}  // namespace Bench
+
+int main(int argc, char **argv) {
+  using namespace Bench;
+  auto config = parse_args(argc, argv);
+  const Case cases[] = {
+      {"empty", empty_tasks},
+      {"cpu_bound", cpu_bound},
+      {"fan_out_in", fan_out_in},
+      {"producer_heavy", producer_heavy},
+      {"consumer_heavy", consumer_heavy},
+  };
+  const Mode modes[] = {
+      {"locked", false, Eden::TaskQueueKind::locked},
+      {"lock_free", false, Eden::TaskQueueKind::lock_free},
+      {"work_stealing", true, Eden::TaskQueueKind::locked},
+  };
+  print_header(config);
+  for (const auto &bench : cases) {
+    if (!config.only.empty() && bench.name != config.only) {
+      continue;
+    }
+    for (const auto &mode : modes) {
+      for (auto threads : config.threads) {
+        run_case(config, bench, mode, threads);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file Coroutine.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief lazy `Eden::task<T>` coroutine running on `Eden::ThreadPool`
+ * @version 0.1
+ * @date 2023-02-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "ThreadPool.hpp"
+
+namespace Eden {
+
+template <typename T>
+class task;
+
+namespace detail {
+
+/**
+ * @brief the part of a `task<T>` promise which does not depend on `T`
+ *
+ */
+class TaskPromiseBase {
+ public:
+  /// @brief resumes whoever awaited the task (symmetric transfer)
+  struct FinalAwaiter {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      if (auto next = handle.promise().continuation) [[likely]] {
+        return next;
+      }
+      return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  /// @brief lazy => nothing runs until the task is awaited
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+
+  /// @brief the coroutine to resume once this one finishes
+  std::coroutine_handle<> continuation{};
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+ public:
+  task<T> get_return_object() noexcept;
+
+  void unhandled_exception() noexcept {
+    result.template emplace<2>(std::current_exception());
+  }
+
+  template <typename U = T>
+    requires std::convertible_to<U &&, T>
+  void return_value(U &&value) {
+    result.template emplace<1>(std::forward<U>(value));
+  }
+
+  /// @brief move the result out (or rethrow the exception)
+  T take() {
+    if (result.index() == 2) [[unlikely]] {
+      std::rethrow_exception(std::get<2>(result));
+    }
+    return std::move(std::get<1>(result));
+  }
+
+ private:
+  /// @brief empty / value / exception
+  std::variant<std::monostate, T, std::exception_ptr> result{};
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+ public:
+  task<void> get_return_object() noexcept;
+
+  void unhandled_exception() noexcept { error = std::current_exception(); }
+
+  void return_void() const noexcept {}
+
+  void take() {
+    if (error) [[unlikely]] {
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  std::exception_ptr error{};
+};
+
+/**
+ * @brief an eager coroutine which destroys itself once it is done
+ *        (used to drive a `task<T>` into a `Promise<T>`)
+ *
+ */
+struct DetachedCoroutine {
+  struct promise_type {
+    DetachedCoroutine get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <typename T>
+DetachedCoroutine fulfill(task<T> work, Promise<T> promise) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(work);
+      promise.set_value();
+    } else {
+      promise.set_value(co_await std::move(work));
+    }
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+  }
+}
+
+template <typename T>
+DetachedCoroutine fulfill_on(ThreadPool &pool, task<T> work,
+                             Promise<T> promise) {
+  try {
+    co_await pool.schedule();
+  } catch (...) {
+    // the pool is stopped => `promise` reports it
+    promise.set_exception(std::current_exception());
+    co_return;
+  }
+  // now on a worker => run `work` right here
+  fulfill(std::move(work), std::move(promise));
+}
+
+}  // namespace detail
+
+/**
+ * @brief A lazily started coroutine producing a `T`.
+ *
+ *        Nothing runs until the task is `co_await`ed. When it finishes, the
+ *        awaiting coroutine is resumed right away on the same thread, so a
+ *        chain of tasks which `co_await pool.schedule()` keeps running on the
+ *        pool without ever blocking a worker.
+ *
+ * @code
+    Eden::task<int> answer(Eden::ThreadPool &pool) {
+      co_await pool.schedule();
+      co_return 42;
+    }
+    Eden::task<int> twice(Eden::ThreadPool &pool) {
+      co_return 2 * co_await answer(pool);
+    }
+    int res = Eden::sync_wait(twice(pool));  // 84
+ * @endcode
+ *
+ * @tparam T
+ */
+template <typename T = void>
+class [[nodiscard]] task {
+  static_assert(!std::is_reference_v<T>, "task<T&> is not supported");
+
+ public:
+  using promise_type = detail::TaskPromise<T>;
+
+  task(task &&moved) noexcept
+      : handle(std::exchange(moved.handle, nullptr)) {}
+
+  task &operator=(task &&moved) noexcept {
+    if (this != &moved) [[likely]] {
+      destroy();
+      handle = std::exchange(moved.handle, nullptr);
+    }
+    return *this;
+  }
+
+  ~task() { destroy(); }
+
+  /// @brief start the task and suspend the awaiting coroutine until it ends
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      [[nodiscard]] bool await_ready() const noexcept { return !handle; }
+
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+
+      T await_resume() {
+        if (!handle) [[unlikely]] {
+          throw std::logic_error("co_await on an empty Eden::task");
+        }
+        return handle.promise().take();
+      }
+    };
+    return Awaiter{handle};
+  }
+
+  /// @brief whether the task owns a coroutine
+  [[nodiscard]] bool valid() const noexcept { return handle != nullptr; }
+
+  // copy constructor and copy assignment operator are deleted
+  task(const task &copied) = delete;
+  task &operator=(const task &copied) = delete;
+
+ private:
+  friend promise_type;
+
+  explicit task(std::coroutine_handle<promise_type> handle) noexcept
+      : handle(handle) {}
+
+  void destroy() noexcept {
+    if (handle) {
+      std::exchange(handle, nullptr).destroy();
+    }
+  }
+
+  std::coroutine_handle<promise_type> handle{};
+};
+
+template <typename T>
+task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+  return task<T>{std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+}
+
+inline task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+  return task<void>{
+      std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+}
+
+/**
+ * @brief start `work` on a worker of `pool` and get a `Future` of its result
+ *
+ * @tparam T
+ * @param pool
+ * @param work
+ * @return Future<T>
+ */
+template <typename T>
+Future<T> spawn(ThreadPool &pool, task<T> work) {
+  Promise<T> promise{};
+  auto future = promise.get_future();
+  detail::fulfill_on(pool, std::move(work), std::move(promise));
+  return std::move(future).via(pool.executor());
+}
+
+/**
+ * @brief run `work` from a thread which is not a coroutine (e.g. `main`)
+ *        and block until it finishes
+ *
+ *        `work` starts on the calling thread and continues wherever it
+ *        `co_await`s to (usually a pool).
+ *
+ * @tparam T
+ * @param work
+ * @return T
+ */
+template <typename T>
+T sync_wait(task<T> work) {
+  Promise<T> promise{};
+  auto future = promise.get_future();
+  detail::fulfill(std::move(work), std::move(promise));
+  return future.get();
+}
+
+}  // namespace Eden
@@ -11,8 +11,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
 #include <utility>
 
+#include "Format/format_buffer.hpp"
+
 #if _GLIBCXX_RELEASE >= 13
 
 // <format> exists <=> the version of `gcc's libstdc++` is higher than 13
@@ -27,8 +34,6 @@
 
 #endif
 
-#if __cpp_lib_format
-
 template <std::size_t LEN>
 struct string_template {
   char str[LEN]{};
@@ -37,8 +42,12 @@ struct string_template {
     /* const string_type& <=> const char (&)[LEN] */
     std::ranges::copy(in, str);
   };
+  /// @brief the literal (without its trailing '\0')
+  constexpr std::string_view view() const { return {str, LEN - 1}; }
 };
 
+#if __cpp_lib_format
+
 template <string_template fmt_str>
 constexpr auto operator""_format() {
   return [=]<typename... Args>(Args&&... args) {
@@ -66,19 +75,84 @@ constexpr std::string format(const char* fmt_str, Args&&... args) {
   return std::vformat(fmt_str, fmt_args);
 }
 
+/**
+ * @brief write `fmt` with `args` to `out` (no `std::string` in between)
+ *
+ * @tparam OutputIt
+ * @tparam Args
+ * @param out
+ * @param fmt
+ * @param args
+ * @return OutputIt past the last char written
+ */
+template <typename OutputIt, typename... Args>
+OutputIt format_to(OutputIt out, std::string_view fmt, const Args&... args) {
+  return std::vformat_to(std::move(out), fmt, std::make_format_args(args...));
+}
+
+template <typename OutputIt>
+using format_to_n_result = std::format_to_n_result<OutputIt>;
+
+/**
+ * @brief `format_to(out, fmt, args...)`, writing at most `n` chars
+ *
+ * @tparam OutputIt
+ * @tparam Args
+ * @param out
+ * @param n
+ * @param fmt
+ * @param args
+ * @return format_to_n_result<OutputIt> (`size` => chars of the whole output)
+ */
+template <typename OutputIt, typename... Args>
+auto format_to_n(OutputIt out, std::iter_difference_t<OutputIt> n,
+                 std::string_view fmt, const Args&... args)
+    -> format_to_n_result<OutputIt> {
+  auto limit = n > 0 ? static_cast<std::size_t>(n) : std::size_t{0};
+  detail::iterator_buffer<OutputIt> buffer{std::move(out), limit};
+  std::vformat_to(std::back_inserter(buffer), fmt,
+                  std::make_format_args(args...));
+  auto count = buffer.count();
+  return {buffer.finish(),
+          static_cast<std::iter_difference_t<OutputIt>>(count)};
+}
+
+/**
+ * @brief number of chars `format(fmt, args...)` would take
+ *
+ * @tparam Args
+ * @param fmt
+ * @param args
+ * @return std::size_t
+ */
+template <typename... Args>
+std::size_t formatted_size(std::string_view fmt, const Args&... args) {
+  detail::counting_buffer buffer{};
+  std::vformat_to(std::back_inserter(buffer), fmt,
+                  std::make_format_args(args...));
+  return buffer.count();
+}
+
 }  // namespace Eden
 
 #else
 
+#include <array>
 #include <concepts>
-#include <functional>
 #include <ios>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <span>
 #include <stdexcept>
+#include <streambuf>
+#include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <unordered_set>
-#include <vector>
+#include <utility>
 
 #include "Concepts.hpp"
 
@@ -101,214 +175,376 @@ void lost_left_bracket_exception() {
 }
 
 /**
- * @brief alias of `std::function<void(std::string &)>`
+ * @brief throw a `std::runtime_error` with message "invalid argument index"
+ *
+ */
+void invalid_arg_index_exception() {
+  throw std::runtime_error{"invalid argument index"};
+}
+
+/**
+ * @brief throw a `std::out_of_range` with message "missing argument"
+ *
+ */
+void missing_arg_exception() {
+  throw std::out_of_range{"missing argument"};
+}
+
+/**
+ * @brief a piece of a format string: either a literal run (`fmt[begin,
+ * begin + size)`, to copy as is) or a placeholder of the `arg`-th argument
+ *
+ */
+struct format_piece {
+  static constexpr std::size_t literal = static_cast<std::size_t>(-1);
+
+  std::size_t begin = 0;
+  std::size_t size = 0;
+  std::size_t arg = literal;
+
+  [[nodiscard]] constexpr bool is_literal() const { return arg == literal; }
+};
+
+/**
+ * @brief split a format string into `format_piece`s, one at a time
+ *        (`{{` / `}}` => a one-char literal, `{}` => next argument,
+ *        `{<integer>}` => that argument)
+ *
+ *        Usable at compile time, where a malformed string (which would throw
+ *        at runtime) is a compile error.
+ *
+ */
+class format_parser {
+ public:
+  constexpr explicit format_parser(std::string_view fmt) : fmt(fmt) {}
+
+  /**
+   * @brief parse the next piece into `piece`
+   *
+   * @param piece
+   * @return false <=> the string is over
+   */
+  constexpr bool next(format_piece &piece) {
+    if (pos == fmt.size()) [[unlikely]] {
+      return false;
+    }
+    auto curr = fmt[pos];
+    if (curr != '{' && curr != '}') [[likely]] {
+      // literal run => until the next bracket
+      auto end = pos + 1;
+      while (end < fmt.size() && fmt[end] != '{' && fmt[end] != '}')
+          [[likely]] {
+        ++end;
+      }
+      piece = {pos, end - pos, format_piece::literal};
+      pos = end;
+      return true;
+    }
+    // `{{` => `{`, `}}` => `}`
+    if (pos + 1 < fmt.size() && fmt[pos + 1] == curr) {
+      piece = {pos, 1, format_piece::literal};
+      pos += 2;
+      return true;
+    }
+    // possible error => missing '{'
+    if (curr == '}') [[unlikely]] {
+      lost_left_bracket_exception();
+    }
+    auto close = pos + 1;
+    while (close < fmt.size() && fmt[close] != '}') [[likely]] {
+      ++close;
+    }
+    // possible error => missing '}'
+    if (close == fmt.size()) [[unlikely]] {
+      lost_right_bracket_exception();
+    }
+    auto sign = fmt.substr(pos + 1, close - pos - 1);
+    std::size_t arg = 0;
+    if (sign.empty()) { /* 1. {} */
+      arg = default_idx++;
+    } else { /* 2. {<integer>} */
+      for (auto digit : sign) [[likely]] {
+        if (digit < '0' || digit > '9') [[unlikely]] {
+          invalid_arg_index_exception();
+        }
+        arg = arg * 10 + static_cast<std::size_t>(digit - '0');
+      }
+    }
+    piece = {pos, close + 1 - pos, arg};
+    pos = close + 1;
+    return true;
+  }
+
+ private:
+  std::string_view fmt;
+  std::size_t pos = 0;
+  std::size_t default_idx = 0;
+};
+
+/**
+ * @brief number of pieces of `fmt_str` (parsed at compile time)
+ *
+ * @tparam fmt_str
+ * @return std::size_t
+ */
+template <string_template fmt_str>
+consteval std::size_t count_format_pieces() {
+  format_parser parser{fmt_str.view()};
+  format_piece piece{};
+  std::size_t count = 0;
+  while (parser.next(piece)) [[likely]] {
+    ++count;
+  }
+  return count;
+}
+
+/**
+ * @brief the pieces of `fmt_str`, parsed at compile time
+ *
+ * @tparam fmt_str
+ */
+template <string_template fmt_str>
+inline constexpr auto parsed_format = [] {
+  std::array<format_piece, count_format_pieces<fmt_str>()> pieces{};
+  format_parser parser{fmt_str.view()};
+  for (auto &piece : pieces) [[likely]] {
+    parser.next(piece);
+  }
+  return pieces;
+}();
+
+/**
+ * @brief number of arguments `fmt_str` refers to (the largest index + 1)
  *
+ * @tparam fmt_str
  */
-using to_string_lambda = std::function<void(std::string &)>;
+template <string_template fmt_str>
+inline constexpr std::size_t format_arg_count = [] {
+  std::size_t count = 0;
+  for (const auto &piece : parsed_format<fmt_str>) [[likely]] {
+    if (!piece.is_literal()) {
+      count = std::max(count, piece.arg + 1);
+    }
+  }
+  return count;
+}();
 
 /**
- * @brief alias of `std::function<void(std::ostringstream &)>`
+ * @brief a type-erased reference to an argument of `format()`: its address,
+ *        and the function appending it to a `format_buffer` (nothing is
+ *        allocated, like `std::basic_format_arg`)
  *
  */
-using oss_obj_lambda = std::function<void(std::ostringstream &)>;
+struct format_arg {
+  const void *value = nullptr;
+  void (*write)(format_buffer &, const void *) = nullptr;
+};
+
+namespace detail {
+
+/// @brief whether `T` is a `std::tuple` or a `std::pair`
+template <typename T>
+struct is_tuple_or_pair : std::false_type {};
+
+template <typename... Args>
+struct is_tuple_or_pair<std::tuple<Args...>> : std::true_type {};
+
+template <typename T, typename U>
+struct is_tuple_or_pair<std::pair<T, U>> : std::true_type {};
+
+}  // namespace detail
 
 /**
- * @brief build a vector of `to_string_lambda` from `args`
+ * @brief append `value` the cheapest way its type allows:
+ *        `bool` => `true` / `false`, `char` => itself, other numbers =>
+ *        `std::to_chars` (shortest round-trip for floats), strings => copied,
+ *        tuples / pairs => element by element, then `std::to_string`, and
+ *        `operator<<` last
+ *
+ * @tparam T
+ * @param buffer
+ * @param value
+ */
+template <string_convertible T>
+void append_format_arg(format_buffer &buffer, const T &value) {
+  if constexpr (std::same_as<T, bool>) {
+    std::string_view str = value ? "true" : "false";
+    buffer.append(str.data(), str.data() + str.size());
+  } else if constexpr (std::same_as<T, char>) {
+    buffer.push_back(value);
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    append_chars(buffer, value);
+  } else if constexpr (std::convertible_to<const T &, std::string_view>) {
+    std::string_view str = value;
+    buffer.append(str.data(), str.data() + str.size());
+  } else if constexpr (detail::is_tuple_or_pair<T>::value) {
+    // as `operator<<` prints them, without a stream or a `std::string`
+    buffer.push_back('(');
+    std::apply(
+        [&buffer](const auto &...elements) {
+          [[maybe_unused]] bool first = true;
+          ((first ? void(first = false) : buffer.append(", ", ", " + 2),
+            append_format_arg(buffer, elements)),
+           ...);
+        },
+        value);
+    buffer.push_back(')');
+  } else if constexpr (could_to_string<T>) {
+    append_to_string(buffer, value);
+  } else {
+    append_streamed(buffer, value);
+  }
+}
+
+template <typename T>
+void write_format_arg(format_buffer &buffer, const void *value) {
+  append_format_arg(buffer, *static_cast<const T *>(value));
+}
+
+template <typename T>
+void write_to_string_arg(format_buffer &buffer, const void *value) {
+  append_to_string(buffer, *static_cast<const T *>(value));
+}
+
+template <typename T>
+void write_oss_obj_arg(format_buffer &buffer, const void *value) {
+  append_streamed(buffer, *static_cast<const T *>(value));
+}
+
+/**
+ * @brief build an array (on the stack) of `format_arg` written by
+ *        `std::to_string` from `args`
  *
  * @tparam Args
  * @param args
- * @return std::vector<to_string_lambda>
+ * @return std::array<format_arg, sizeof...(Args)>
  */
 template <could_to_string... Args>
-auto build_to_string_vec(Args &&...args) -> std::vector<to_string_lambda> {
-  return {[&args](std::string &str) {
-    str += std::to_string(std::forward<Args>(args));
-  }...};
+auto make_to_string_args(const Args &...args)
+    -> std::array<format_arg, sizeof...(Args)> {
+  return {format_arg{std::addressof(args), &write_to_string_arg<Args>}...};
 }
 
 /**
- * @brief build a vector of `oss_obj_lambda` from `args`
+ * @brief build an array (on the stack) of `format_arg` written by `<<` from
+ *        `args`
  *
  * @tparam Args
  * @param args
- * @return std::vector<oss_obj_lambda>
+ * @return std::array<format_arg, sizeof...(Args)>
  */
 template <oss_obj_operative... Args>
-auto build_oss_obj_vec(Args &&...args) -> std::vector<oss_obj_lambda> {
-  return {[&args](std::ostringstream &oss) { oss << args; }...};
+auto make_oss_obj_args(const Args &...args)
+    -> std::array<format_arg, sizeof...(Args)> {
+  return {format_arg{std::addressof(args), &write_oss_obj_arg<Args>}...};
 }
 
 /**
- * @brief helper of `format(fmt, args...)` (only support `{{` `}}`
- * transcription)
+ * @brief build an array (on the stack) of `format_arg` from `args`, each
+ *        written by `append_format_arg`
  *
  * @tparam Args
+ * @param args
+ * @return std::array<format_arg, sizeof...(Args)>
+ */
+template <string_convertible... Args>
+auto make_format_args(const Args &...args)
+    -> std::array<format_arg, sizeof...(Args)> {
+  return {format_arg{std::addressof(args), &write_format_arg<Args>}...};
+}
+
+/**
+ * @brief append `piece` of `fmt` to `buffer` (an argument through `args`)
+ *
+ * @param buffer
  * @param fmt
- * @param args_vec
- * @return std::string
+ * @param piece
+ * @param args
  */
-template <oss_obj_operative... Args>
-std::string basic_format_helper(const std::string_view fmt,
-                                const std::vector<oss_obj_lambda> &args_vec) {
-  std::ostringstream oss{};
-  oss.setf(std::ios_base::boolalpha);  // open `boolalpha` option
-  std::size_t default_idx = 0;
-  for (auto iter = fmt.begin(); iter != fmt.end(); ++iter) [[likely]] {
-    // if could match `{{` as `{`
-    bool if_left_bracket_transcription =
-        *iter == '{' && std::next(iter) != fmt.end() && *std::next(iter) == '{';
-    // if could match `}}` as `}`
-    bool if_right_bracket_transcription =
-        *iter == '}' && std::next(iter) != fmt.end() && *std::next(iter) == '}';
-    // if could transcription
-    bool if_bracket_transcription =
-        if_left_bracket_transcription || if_right_bracket_transcription;
-    // if it's a single bracket
-    bool if_single_bracket = *iter == '{' || *iter == '}';
-    // if it's not a arg
-    bool if_not_arg = if_bracket_transcription || !if_single_bracket;
-    // cases
-    if (if_not_arg) [[unlikely]] {
-      // 1.1 => if not transcription
-      oss << *iter;
-      // 1.2 => if transcription
-      if (if_bracket_transcription) {
-        ++iter;
-      }
-    } else [[likely]] {
-      // possible error => missing '{'
-      if (*iter == '}') [[unlikely]] {
-        lost_left_bracket_exception();
-      }
-      // find `begin_iter` and `end_iter` of the `sign`
-      auto bof_sign = iter;
-      ++bof_sign;
-      auto eof_sign = bof_sign;
-      /**
-       * @code
-          while (eof_sign != fmt.end() && *eof_sign != '}') [[likely]] {
-            ++eof_sign;
-          }
-       *
-       */
-      while (eof_sign != fmt.end()) [[likely]] {
-        if (*eof_sign == '}') [[unlikely]] {
-          if (std::next(eof_sign) != fmt.end() && *std::next(eof_sign) == '}')
-              [[unlikely]] {
-            ++eof_sign;
-          } else [[likely]] {
-            break;
-          }
-        } else [[likely]] {
-          ++eof_sign;
-        }
-      }
-      // possible error => missing '}'
-      if (*eof_sign != '}') [[unlikely]] {
-        lost_right_bracket_exception();
-      }
-      // update `iter` to `end_of_sign`
-      iter = eof_sign;
-      // now, pick the sign
-      std::string_view sign{bof_sign, eof_sign};
-      // two cases
-      if (sign.empty()) { /* 1. {} */
-        args_vec.at(default_idx)(oss);
-        ++default_idx;
-      } else { /* 2. {<integer>} */
-        std::size_t idx = std::stoi(std::string{sign});
-        args_vec.at(idx)(oss);
-      }
-    }
+inline void put_format_piece(format_buffer &buffer, const std::string_view fmt,
+                             const format_piece &piece,
+                             std::span<const format_arg> args) {
+  if (piece.is_literal()) [[likely]] {
+    auto *first = fmt.data() + piece.begin;
+    buffer.append(first, first + piece.size);
+    return;
+  }
+  // possible error => `{<integer>}` past the last argument
+  if (piece.arg >= args.size()) [[unlikely]] {
+    missing_arg_exception();
+  }
+  args[piece.arg].write(buffer, args[piece.arg].value);
+}
+
+/**
+ * @brief append `fmt` with `args` to `buffer` (only support `{{` `}}`
+ * transcription)
+ *
+ * @param buffer
+ * @param fmt
+ * @param args
+ */
+inline void vformat_to(format_buffer &buffer, const std::string_view fmt,
+                       std::span<const format_arg> args) {
+  format_parser parser{fmt};
+  format_piece piece{};
+  while (parser.next(piece)) [[likely]] {
+    put_format_piece(buffer, fmt, piece, args);
   }
-  return oss.str();
 }
 
 /**
  * @brief helper of `format(fmt, args...)` (only support `{{` `}}`
  * transcription)
  *
- * @tparam Args
  * @param fmt
- * @param args_vec
+ * @param args
  * @return std::string
  */
-template <oss_obj_operative... Args>
-std::string basic_format_helper(const std::string_view fmt,
-                                const std::vector<to_string_lambda> &args_vec) {
+inline std::string basic_format_helper(const std::string_view fmt,
+                                       std::span<const format_arg> args) {
   std::string result{};
-  std::size_t default_idx = 0;
-  for (auto iter = fmt.begin(); iter != fmt.end(); ++iter) [[likely]] {
-    // if could match `{{` as `{`
-    bool if_left_bracket_transcription =
-        *iter == '{' && std::next(iter) != fmt.end() && *std::next(iter) == '{';
-    // if could match `}}` as `}`
-    bool if_right_bracket_transcription =
-        *iter == '}' && std::next(iter) != fmt.end() && *std::next(iter) == '}';
-    // if could transcription
-    bool if_bracket_transcription =
-        if_left_bracket_transcription || if_right_bracket_transcription;
-    // if it's a single bracket
-    bool if_single_bracket = *iter == '{' || *iter == '}';
-    // if it's not a arg
-    bool if_not_arg = if_bracket_transcription || !if_single_bracket;
-    // cases
-    if (if_not_arg) [[likely]] {
-      // 1.1 => if not transcription
-      result += *iter;
-      // 1.2 => if transcription
-      if (if_bracket_transcription) [[unlikely]] {
-        ++iter;
-      }
-    } else [[unlikely]] {
-      // possible error => missing '{'
-      if (*iter == '}') [[unlikely]] {
-        lost_left_bracket_exception();
-      }
-      // find `begin_iter` and `end_iter` of the `sign`
-      auto bof_sign = iter;
-      ++bof_sign;
-      auto eof_sign = bof_sign;
-      /**
-       * @code
-          while (eof_sign != fmt.end() && *eof_sign != '}') [[likely]] {
-            ++eof_sign;
-          }
-       *
-       */
-      while (eof_sign != fmt.end()) [[likely]] {
-        if (*eof_sign == '}') [[unlikely]] {
-          if (std::next(eof_sign) != fmt.end() && *std::next(eof_sign) == '}')
-              [[unlikely]] {
-            ++eof_sign;
-          } else [[likely]] {
-            break;
-          }
-        } else [[likely]] {
-          ++eof_sign;
-        }
-      }
-      // possible error => missing '}'
-      if (*eof_sign != '}') [[unlikely]] {
-        lost_right_bracket_exception();
-      }
-      // update `iter` to `end_of_sign`
-      iter = eof_sign;
-      // now, pick the sign
-      std::string_view sign{bof_sign, eof_sign};
-      // two cases
-      if (sign.empty()) { /* 1. {} */
-        args_vec.at(default_idx)(result);
-        ++default_idx;
-      } else { /* 2. {<integer>} */
-        std::size_t idx = std::stoi(std::string{sign});
-        args_vec.at(idx)(result);
-      }
-    }
+  {
+    detail::container_buffer<std::string> buffer{result};
+    vformat_to(buffer, fmt, args);
   }
   return result;
 }
 
+namespace detail {
+
+/**
+ * @brief run `emit` on the cheapest `format_buffer` writing to `out`
+ *
+ * @tparam OutputIt
+ * @tparam Emit
+ * @param out
+ * @param emit
+ * @return OutputIt past the last char written
+ */
+template <typename OutputIt, typename Emit>
+OutputIt write_through(OutputIt out, Emit &&emit) {
+  using Target = typename back_insert_target<OutputIt>::type;
+  if constexpr (std::same_as<OutputIt, char *>) {
+    pointer_buffer buffer{out};
+    emit(buffer);
+    return buffer.end();
+  } else if constexpr (std::derived_from<Target, format_buffer>) {
+    emit(static_cast<format_buffer &>(container_of(out)));
+    return out;
+  } else if constexpr (is_char_back_inserter<OutputIt>::value) {
+    container_buffer<Target> buffer{container_of(out)};
+    emit(buffer);
+    return out;
+  } else {
+    iterator_buffer<OutputIt> buffer{std::move(out)};
+    emit(buffer);
+    return buffer.finish();
+  }
+}
+
+}  // namespace detail
+
 /**
  * @brief return a `std::string` in `fmt` with `args` (args all satisfy
  * `could_to_string` constraint) => only used for `Print(fmt, args...)`
@@ -320,8 +556,8 @@ std::string basic_format_helper(const std::string_view fmt,
  */
 template <could_to_string... Args>
 std::string could_to_string_format(const std::string_view fmt, Args &&...args) {
-  auto args_vec = build_to_string_vec(std::forward<Args>(args)...);
-  return basic_format_helper(fmt, std::move(args_vec));
+  auto fmt_args = make_to_string_args(args...);
+  return basic_format_helper(fmt, fmt_args);
 }
 
 /**
@@ -336,8 +572,8 @@ std::string could_to_string_format(const std::string_view fmt, Args &&...args) {
 template <oss_obj_operative... Args>
 std::string oss_obj_operative_format(const std::string_view fmt,
                                      Args &&...args) {
-  auto args_vec = build_oss_obj_vec(std::forward<Args>(args)...);
-  return basic_format_helper(fmt, std::move(args_vec));
+  auto fmt_args = make_oss_obj_args(args...);
+  return basic_format_helper(fmt, fmt_args);
 }
 
 /**
@@ -351,13 +587,8 @@ std::string oss_obj_operative_format(const std::string_view fmt,
  */
 template <string_convertible... Args>
 std::string format(const std::string_view fmt, Args &&...args) {
-  if constexpr (sizeof...(args) == 0 or
-                could_to_string<typename std::common_type<Args...>::type>) {
-    auto args_vec = build_to_string_vec(std::forward<Args>(args)...);
-    return basic_format_helper(fmt, std::move(args_vec));
-  }
-  auto args_vec = build_oss_obj_vec(std::forward<Args>(args)...);
-  return basic_format_helper(fmt, std::move(args_vec));
+  auto fmt_args = make_format_args(args...);
+  return basic_format_helper(fmt, fmt_args);
 }
 
 /**
@@ -365,8 +596,137 @@ std::string format(const std::string_view fmt, Args &&...args) {
  *
  * @return std::string
  */
-std::string format() { return ""; }
+inline std::string format() { return ""; }
+
+/**
+ * @brief write `fmt` with `args` to `out` (no `std::string` in between)
+ *
+ * @code
+    std::string line{};
+    for (auto value : values) {
+      Eden::format_to(std::back_inserter(line), "{} ", value);
+    }
+ * @endcode
+ *
+ * @tparam OutputIt
+ * @tparam Args
+ * @param out
+ * @param fmt
+ * @param args
+ * @return OutputIt past the last char written
+ */
+template <typename OutputIt, string_convertible... Args>
+OutputIt format_to(OutputIt out, const std::string_view fmt,
+                   const Args &...args) {
+  auto fmt_args = make_format_args(args...);
+  return detail::write_through(std::move(out), [&](format_buffer &buffer) {
+    vformat_to(buffer, fmt, fmt_args);
+  });
+}
+
+/**
+ * @brief result of `format_to_n()`
+ *
+ * @tparam OutputIt
+ */
+template <typename OutputIt>
+struct format_to_n_result {
+  /// @brief past the last char written
+  OutputIt out;
+  /// @brief chars the whole output would take (written or not)
+  std::iter_difference_t<OutputIt> size;
+};
+
+/**
+ * @brief `format_to(out, fmt, args...)`, writing at most `n` chars
+ *
+ * @tparam OutputIt
+ * @tparam Args
+ * @param out
+ * @param n
+ * @param fmt
+ * @param args
+ * @return format_to_n_result<OutputIt>
+ */
+template <typename OutputIt, string_convertible... Args>
+auto format_to_n(OutputIt out, std::iter_difference_t<OutputIt> n,
+                 const std::string_view fmt, const Args &...args)
+    -> format_to_n_result<OutputIt> {
+  using Diff = std::iter_difference_t<OutputIt>;
+  auto fmt_args = make_format_args(args...);
+  auto limit = n > 0 ? static_cast<std::size_t>(n) : std::size_t{0};
+  if constexpr (std::same_as<OutputIt, char *>) {
+    detail::pointer_buffer buffer{out, limit};
+    vformat_to(buffer, fmt, fmt_args);
+    return {buffer.end(), static_cast<Diff>(buffer.count())};
+  } else {
+    detail::iterator_buffer<OutputIt> buffer{std::move(out), limit};
+    vformat_to(buffer, fmt, fmt_args);
+    auto count = buffer.count();
+    return {buffer.finish(), static_cast<Diff>(count)};
+  }
+}
+
+/**
+ * @brief number of chars `format(fmt, args...)` would take
+ *
+ * @tparam Args
+ * @param fmt
+ * @param args
+ * @return std::size_t
+ */
+template <string_convertible... Args>
+std::size_t formatted_size(const std::string_view fmt, const Args &...args) {
+  auto fmt_args = make_format_args(args...);
+  detail::counting_buffer buffer{};
+  vformat_to(buffer, fmt, fmt_args);
+  return buffer.count();
+}
+
+/**
+ * @brief `format(fmt_str, args...)` with `fmt_str` parsed at compile time
+ *        (only the literal runs and the arguments are left to the runtime)
+ *
+ * @tparam fmt_str
+ * @tparam Args
+ * @param args
+ * @return std::string
+ */
+template <string_template fmt_str, string_convertible... Args>
+std::string compiled_format(Args &&...args) {
+  static_assert(format_arg_count<fmt_str> <= sizeof...(Args),
+                "the format string refers to a missing argument");
+  constexpr auto fmt = fmt_str.view();
+  auto fmt_args = make_format_args(args...);
+  std::string result{};
+  {
+    detail::container_buffer<std::string> buffer{result};
+    for (const auto &piece : parsed_format<fmt_str>) [[likely]] {
+      put_format_piece(buffer, fmt, piece, fmt_args);
+    }
+  }
+  return result;
+}
 
 }  // namespace Eden
 
+template <string_template fmt_str>
+constexpr auto operator""_format() {
+  return [=]<typename... Args>(Args&&... args) {
+    return Eden::compiled_format<fmt_str>(std::forward<Args>(args)...);
+  };
+}
+template <string_template fmt_str>
+constexpr auto operator""_fmt() {
+  return [=]<typename... Args>(Args&&... args) {
+    return Eden::compiled_format<fmt_str>(std::forward<Args>(args)...);
+  };
+}
+template <string_template fmt_str>
+constexpr auto operator""_f() {
+  return [=]<typename... Args>(Args&&... args) {
+    return Eden::compiled_format<fmt_str>(std::forward<Args>(args)...);
+  };
+}
+
 #endif
@@ -0,0 +1,481 @@
+/**
+ * @file format_buffer.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief output buffers behind `Eden::format_to()` and friends
+ * @version 0.1
+ * @date 2023-02-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "../Concepts.hpp"
+
+namespace Eden {
+
+/**
+ * @brief A contiguous run of chars which the formatter appends to.
+ *
+ *        Appending is a bounds check and a copy; when the buffer is full, the
+ *        derived class's `grow()` makes room, either by growing (e.g. the
+ *        container it writes into) or by flushing what it holds (e.g. to an
+ *        output iterator).
+ *
+ */
+class format_buffer {
+ public:
+  /// @brief (for `std::back_inserter()`)
+  using value_type = char;
+
+  void push_back(char ch) {
+    if (used == cap) [[unlikely]] {
+      grow(used + 1);
+    }
+    ptr[used++] = ch;
+  }
+
+  void append(const char *first, const char *last) {
+    while (first != last) [[likely]] {
+      if (used == cap) [[unlikely]] {
+        grow(used + static_cast<std::size_t>(last - first));
+      }
+      auto count =
+          std::min(cap - used, static_cast<std::size_t>(last - first));
+      std::copy_n(first, count, ptr + used);
+      used += count;
+      first += count;
+    }
+  }
+
+  [[nodiscard]] char *data() noexcept { return ptr; }
+  [[nodiscard]] const char *data() const noexcept { return ptr; }
+
+  /// @brief chars held (those flushed by `grow()` excluded)
+  [[nodiscard]] std::size_t size() const noexcept { return used; }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return cap; }
+
+  void clear() noexcept { used = 0; }
+
+  // copy constructor and copy assignment operator are deleted
+  format_buffer(const format_buffer &copied) = delete;
+  format_buffer &operator=(const format_buffer &copied) = delete;
+
+ protected:
+  format_buffer(char *ptr, std::size_t used, std::size_t cap) noexcept
+      : ptr(ptr), used(used), cap(cap) {}
+
+  ~format_buffer() = default;
+
+  /**
+   * @brief make room for at least one more char
+   *
+   * @param wanted the capacity which would fit the pending write
+   */
+  virtual void grow(std::size_t wanted) = 0;
+
+  void set(char *data, std::size_t size, std::size_t capacity) noexcept {
+    ptr = data;
+    used = size;
+    cap = capacity;
+  }
+
+ private:
+  char *ptr;
+  std::size_t used;
+  std::size_t cap;
+};
+
+/**
+ * @brief a `std::streambuf` appending to a `format_buffer`
+ *        (so that `operator<<` writes in place, no `std::ostringstream`)
+ *
+ */
+class format_streambuf final : public std::streambuf {
+ public:
+  explicit format_streambuf(format_buffer &buffer) : buffer(buffer) {}
+
+ protected:
+  int_type overflow(int_type ch) override {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) [[likely]] {
+      buffer.push_back(traits_type::to_char_type(ch));
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  std::streamsize xsputn(const char *str, std::streamsize count) override {
+    buffer.append(str, str + count);
+    return count;
+  }
+
+ private:
+  format_buffer &buffer;
+};
+
+/**
+ * @brief append `value` as `operator<<` prints it (`boolalpha` on)
+ *
+ * @tparam T
+ * @param buffer
+ * @param value
+ */
+template <typename T>
+void append_streamed(format_buffer &buffer, const T &value) {
+  format_streambuf streambuf{buffer};
+  std::ostream os{&streambuf};
+  os.setf(std::ios_base::boolalpha);  // open `boolalpha` option
+  os << value;
+}
+
+/**
+ * @brief append `value` by `std::to_chars` (no allocation, no locale)
+ *        => a float is written in its shortest round-trip form
+ *
+ * @tparam T
+ * @param buffer
+ * @param value
+ */
+template <typename T>
+  requires(std::is_arithmetic_v<T> && !std::same_as<T, bool>)
+void append_chars(format_buffer &buffer, T value) {
+  // enough for any integer, and for the shortest form of any float
+  char chars[64];
+  auto [end, error] = std::to_chars(chars, chars + sizeof(chars), value);
+  buffer.append(chars, end);
+}
+
+/**
+ * @brief append `value` as `std::to_string` prints it, or as `operator<<`
+ *        does if `std::to_string` can't
+ *
+ * @tparam T
+ * @param buffer
+ * @param value
+ */
+template <string_convertible T>
+void append_to_string(format_buffer &buffer, const T &value) {
+  if constexpr (std::integral<T> && !std::same_as<T, bool>) {
+    // same digits as `std::to_string`, without the `std::string`
+    append_chars(buffer, value);
+  } else if constexpr (could_to_string<T>) {
+    auto str = std::to_string(value);
+    buffer.append(str.data(), str.data() + str.size());
+  } else {
+    append_streamed(buffer, value);
+  }
+}
+
+/**
+ * @brief A `format_buffer` holding its first `N` chars inline (e.g. on the
+ *        stack), then spilling to memory from `Allocator`, growing by half
+ *        each time.
+ *
+ *        The default `N` fits most formatted lines, so formatting one
+ *        allocates nothing:
+ *
+ * @code
+    Eden::memory_buffer<> line{};
+    Eden::format_to(std::back_inserter(line), "{}: {}", key, value);
+    std::fwrite(line.data(), 1, line.size(), stdout);
+ * @endcode
+ *
+ * @tparam N
+ * @tparam Allocator
+ */
+template <std::size_t N = 256, typename Allocator = std::allocator<char>>
+class memory_buffer final : public format_buffer {
+  static_assert(N > 0, "memory_buffer needs inline storage");
+
+ public:
+  using allocator_type = Allocator;
+
+  explicit memory_buffer(const Allocator &alloc = Allocator{})
+      : format_buffer(storage, 0, N), alloc(alloc) {}
+
+  memory_buffer(memory_buffer &&moved) noexcept
+      : format_buffer(storage, 0, N), alloc(std::move(moved.alloc)) {
+    take(moved);
+  }
+
+  memory_buffer &operator=(memory_buffer &&moved) noexcept {
+    if (this != &moved) [[likely]] {
+      release();
+      alloc = std::move(moved.alloc);
+      take(moved);
+    }
+    return *this;
+  }
+
+  ~memory_buffer() { release(); }
+
+  /// @brief make room for `capacity` chars up front
+  void reserve(std::size_t capacity) {
+    if (capacity > this->capacity()) {
+      grow(capacity);
+    }
+  }
+
+  [[nodiscard]] std::string_view view() const noexcept {
+    return {data(), size()};
+  }
+
+  [[nodiscard]] const char *begin() const noexcept { return data(); }
+  [[nodiscard]] const char *end() const noexcept { return data() + size(); }
+
+  [[nodiscard]] allocator_type get_allocator() const { return alloc; }
+
+ protected:
+  void grow(std::size_t wanted) override {
+    auto capacity = std::max(wanted, this->capacity() + this->capacity() / 2);
+    auto *heap = std::allocator_traits<Allocator>::allocate(alloc, capacity);
+    std::copy_n(data(), size(), heap);
+    release();
+    set(heap, size(), capacity);
+  }
+
+ private:
+  /// @brief give back the heap block (if any)
+  void release() noexcept {
+    if (data() != storage) {
+      std::allocator_traits<Allocator>::deallocate(alloc, data(), capacity());
+    }
+  }
+
+  /// @brief take the chars of `moved` (its block, or a copy of its inline
+  ///        chars), leaving it empty
+  void take(memory_buffer &moved) noexcept {
+    if (moved.data() == moved.storage) {
+      std::copy_n(moved.storage, moved.size(), storage);
+      set(storage, moved.size(), N);
+    } else {
+      set(moved.data(), moved.size(), moved.capacity());
+    }
+    moved.set(moved.storage, 0, N);
+  }
+
+  char storage[N];
+  [[no_unique_address]] Allocator alloc;
+};
+
+/**
+ * @brief the chars of `buffer` as a `std::string`
+ *
+ * @tparam N
+ * @tparam Allocator
+ * @param buffer
+ * @return std::string
+ */
+template <std::size_t N, typename Allocator>
+std::string to_string(const memory_buffer<N, Allocator> &buffer) {
+  return std::string{buffer.data(), buffer.size()};
+}
+
+namespace detail {
+
+/// @brief the container a `std::back_insert_iterator` appends to
+///        (`void` for other iterators)
+template <typename OutputIt>
+struct back_insert_target {
+  using type = void;
+};
+
+template <typename Container>
+struct back_insert_target<std::back_insert_iterator<Container>> {
+  using type = Container;
+};
+
+/// @brief whether `OutputIt` is a `std::back_insert_iterator` of a resizable
+///        contiguous container of `char` (e.g. `std::string`)
+template <typename OutputIt>
+struct is_char_back_inserter : std::false_type {};
+
+template <typename Container>
+  requires requires(Container &container) {
+    requires std::same_as<typename Container::value_type, char>;
+    { container.data() } -> std::same_as<char *>;
+    { container.capacity() } -> std::convertible_to<std::size_t>;
+    container.resize(std::size_t{});
+  }
+struct is_char_back_inserter<std::back_insert_iterator<Container>>
+    : std::true_type {};
+
+/// @brief the container behind a `std::back_insert_iterator`
+template <typename Container>
+Container &container_of(std::back_insert_iterator<Container> out) {
+  struct accessor : std::back_insert_iterator<Container> {
+    explicit accessor(std::back_insert_iterator<Container> out)
+        : std::back_insert_iterator<Container>(out) {}
+    using std::back_insert_iterator<Container>::container;
+  };
+  return *accessor{out}.container;
+}
+
+/**
+ * @brief appends to a container in place (no intermediate copy): the
+ *        container is resized as the buffer grows, then trimmed to what was
+ *        written when the buffer goes away
+ *
+ *        Only a small chunk past the current end is resized in up front (not
+ *        the whole spare capacity), so appending in a loop stays linear.
+ *
+ * @tparam Container
+ */
+template <typename Container>
+class container_buffer final : public format_buffer {
+  /// @brief chars resized in at first (and at least at each growth)
+  static constexpr std::size_t chunk_size = 64;
+
+ public:
+  explicit container_buffer(Container &container)
+      : format_buffer(nullptr, 0, 0),
+        container(container),
+        start(container.size()) {
+    // the spare capacity already there (if any) saves an allocation
+    auto spare = container.capacity() - start;
+    auto capacity = spare > 0 ? std::min(spare, chunk_size) : chunk_size;
+    container.resize(start + capacity);
+    set(container.data() + start, 0, capacity);
+  }
+
+  ~container_buffer() { container.resize(start + size()); }
+
+ protected:
+  void grow(std::size_t wanted) override {
+    // geometric, like the container itself
+    auto capacity = std::max({wanted, 2 * this->capacity(), chunk_size});
+    container.resize(start + capacity);
+    set(container.data() + start, size(), capacity);
+  }
+
+ private:
+  Container &container;
+  /// @brief size of the container before formatting
+  std::size_t start;
+};
+
+/**
+ * @brief writes straight into `[out, out + limit)`, and only counts what
+ *        does not fit
+ *
+ */
+class pointer_buffer final : public format_buffer {
+ public:
+  explicit pointer_buffer(char *out,
+                          std::size_t limit =
+                              std::numeric_limits<std::size_t>::max())
+      : format_buffer(out, 0, limit), out(out), limit(limit) {}
+
+  /// @brief past the last char written
+  [[nodiscard]] char *end() const noexcept {
+    return out + (overflowed ? limit : size());
+  }
+
+  /// @brief chars formatted (written or not)
+  [[nodiscard]] std::size_t count() const noexcept {
+    return overflowed ? limit + dropped + size() : size();
+  }
+
+ protected:
+  void grow(std::size_t /* wanted */) override {
+    // `[out, out + limit)` is full => count the rest in `scratch`
+    if (overflowed) {
+      dropped += size();
+    }
+    overflowed = true;
+    set(scratch, 0, sizeof(scratch));
+  }
+
+ private:
+  char *out;
+  std::size_t limit;
+  bool overflowed = false;
+  /// @brief chars which went through `scratch` before the last one
+  std::size_t dropped = 0;
+  char scratch[64];
+};
+
+/**
+ * @brief buffers up to 256 chars at a time on the stack, then copies them to
+ *        `out` (at most `limit` chars in total, the rest being only counted)
+ *
+ * @tparam OutputIt
+ */
+template <typename OutputIt>
+class iterator_buffer final : public format_buffer {
+ public:
+  explicit iterator_buffer(
+      OutputIt out,
+      std::size_t limit = std::numeric_limits<std::size_t>::max())
+      : format_buffer(chunk, 0, sizeof(chunk)),
+        out(std::move(out)),
+        limit(limit) {}
+
+  /// @brief flush, and return past the last char written
+  OutputIt finish() {
+    flush();
+    return std::move(out);
+  }
+
+  /// @brief chars formatted (written or not)
+  [[nodiscard]] std::size_t count() const noexcept {
+    return flushed + size();
+  }
+
+ protected:
+  void grow(std::size_t /* wanted */) override { flush(); }
+
+ private:
+  void flush() {
+    auto room = limit - std::min(limit, flushed);
+    out = std::copy_n(data(), std::min(size(), room), std::move(out));
+    flushed += size();
+    clear();
+  }
+
+  char chunk[256];
+  OutputIt out;
+  std::size_t limit;
+  /// @brief chars moved out of `chunk` so far
+  std::size_t flushed = 0;
+};
+
+/// @brief only counts the chars (for `formatted_size()`)
+class counting_buffer final : public format_buffer {
+ public:
+  counting_buffer() : format_buffer(chunk, 0, sizeof(chunk)) {}
+
+  [[nodiscard]] std::size_t count() const noexcept {
+    return dropped + size();
+  }
+
+ protected:
+  void grow(std::size_t /* wanted */) override {
+    dropped += size();
+    clear();
+  }
+
+ private:
+  char chunk[128];
+  std::size_t dropped = 0;
+};
+
+}  // namespace detail
+
+}  // namespace Eden
@@ -0,0 +1,209 @@
+/**
+ * @file MPMCQueue.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief lock-free bounded multi-producer/multi-consumer queue
+ * @version 0.1
+ * @date 2023-02-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Eden {
+
+/**
+ * @brief A bounded lock-free MPMC queue (ring buffer of sequenced cells).
+ *
+ *        Every cell carries a sequence number telling whether it is ready to
+ *        be written (`sequence == pos`) or read (`sequence == pos + 1`).
+ *        Producers and consumers only contend on one CAS each, and never on
+ *        the same counter.
+ *
+ * @code
+    Eden::MPMCQueue<int> queue{1024};
+    queue.try_push(1);
+    int value{};
+    queue.try_pop(value);  // value == 1
+ * @endcode
+ *
+ * @tparam T must be nothrow move constructible
+ */
+template <typename T>
+class MPMCQueue {
+  static_assert(std::is_nothrow_move_constructible_v<T>,
+                "MPMCQueue<T> requires a nothrow move constructible `T`");
+
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T *value() { return std::launder(reinterpret_cast<T *>(storage)); }
+  };
+
+ public:
+  /// @brief Construct a new MPMCQueue (`capacity` is rounded up to 2^n)
+  explicit MPMCQueue(std::size_t capacity) {
+    std::size_t size = 2;
+    while (size < capacity) [[likely]] {
+      size <<= 1;
+    }
+    mask = size - 1;
+    buffer = std::make_unique<Cell[]>(size);
+    for (std::size_t i = 0; i < size; ++i) [[likely]] {
+      buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~MPMCQueue() {
+    // no one is touching the queue anymore => destroy what is left
+    auto pos = dequeuePos.load(std::memory_order_relaxed);
+    auto end = enqueuePos.load(std::memory_order_relaxed);
+    for (; pos != end; ++pos) [[likely]] {
+      buffer[pos & mask].value()->~T();
+    }
+  }
+
+  /**
+   * @brief construct an element in place
+   *
+   * @return false <=> the queue is full (nothing is pushed)
+   */
+  template <typename... Args>
+  bool try_emplace(Args &&...args) {
+    if constexpr (std::is_nothrow_constructible_v<T, Args &&...>) {
+      Cell *cell = acquire_write_cell();
+      if (cell == nullptr) [[unlikely]] {
+        return false;
+      }
+      ::new (cell->storage) T(std::forward<Args>(args)...);
+      publish(cell);
+    } else {
+      // build it before claiming a cell => a throwing constructor can't leave
+      // a claimed but unpublished cell (which would wedge every consumer)
+      T item(std::forward<Args>(args)...);
+      Cell *cell = acquire_write_cell();
+      if (cell == nullptr) [[unlikely]] {
+        return false;
+      }
+      ::new (cell->storage) T(std::move(item));
+      publish(cell);
+    }
+    return true;
+  }
+
+  /// @brief push `item` (it is only moved from when `true` is returned)
+  bool try_push(T &&item) { return try_emplace(std::move(item)); }
+
+  /// @brief push a copy of `item`
+  bool try_push(const T &item) { return try_emplace(item); }
+
+  /// @brief push `item`, yielding while the queue is full
+  void push(T item) {
+    while (!try_push(std::move(item))) [[unlikely]] {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief pop the front element into `out`
+   *
+   * @return false <=> the queue is empty
+   */
+  bool try_pop(T &out) {
+    Cell *cell = nullptr;
+    auto pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;) [[likely]] {
+      cell = &buffer[pos & mask];
+      auto seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) [[likely]] {
+        if (dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    out = std::move(*cell->value());
+    cell->value()->~T();
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief approximate number of elements (exact when the queue is idle)
+  [[nodiscard]] std::size_t size() const {
+    auto head = dequeuePos.load(std::memory_order_seq_cst);
+    auto tail = enqueuePos.load(std::memory_order_seq_cst);
+    return tail > head ? tail - head : 0;
+  }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  /// @brief maximum number of elements
+  [[nodiscard]] std::size_t capacity() const { return mask + 1; }
+
+  // copy constructor and copy assignment operator are deleted
+  MPMCQueue(const MPMCQueue &copied) = delete;
+  MPMCQueue &operator=(const MPMCQueue &copied) = delete;
+
+  // move constructor and move assignment operator are deleted
+  MPMCQueue(MPMCQueue &&moved) = delete;
+  MPMCQueue &operator=(MPMCQueue &&moved) = delete;
+
+ private:
+  /// @brief claim the cell at the tail (`nullptr` if the queue is full)
+  Cell *acquire_write_cell() {
+    auto pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) [[likely]] {
+      Cell *cell = &buffer[pos & mask];
+      auto seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) [[likely]] {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          return cell;
+        }
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// @brief make a claimed and constructed cell visible to consumers
+  void publish(Cell *cell) {
+    auto seq = cell->sequence.load(std::memory_order_relaxed);
+    cell->sequence.store(seq + 1, std::memory_order_release);
+  }
+
+  /// @brief ring buffer (size is a power of two)
+  std::unique_ptr<Cell[]> buffer;
+
+  /// @brief `capacity() - 1`
+  std::size_t mask = 0;
+
+  /// @brief next position to write (padded against false sharing)
+  alignas(64) std::atomic<std::size_t> enqueuePos = 0;
+
+  /// @brief next position to read (padded against false sharing)
+  alignas(64) std::atomic<std::size_t> dequeuePos = 0;
+};
+
+}  // namespace Eden
@@ -19,6 +19,29 @@
 #include <utility>
 
 #include "../Concepts.hpp"
+#include "../Format/format_buffer.hpp"
+
+namespace Eden {
+
+/**
+ * @brief append `pair` as `std::to_string(pair)` returns it, e.g. to a
+ *        `memory_buffer`
+ *
+ * @tparam T
+ * @tparam U
+ * @param buffer
+ * @param pair
+ */
+template <string_convertible T, string_convertible U>
+void to_string_to(format_buffer &buffer, const std::pair<T, U> &pair) {
+  buffer.push_back('(');
+  append_to_string(buffer, pair.first);
+  buffer.append(", ", ", " + 2);
+  append_to_string(buffer, pair.second);
+  buffer.push_back(')');
+}
+
+}  // namespace Eden
 
 namespace std {
 
@@ -45,29 +68,9 @@ std::ostream &operator<<(std::ostream &os, const std::pair<T, U> &p) {
  */
 template <Eden::string_convertible T, Eden::string_convertible U>
 std::string to_string(const std::pair<T, U> &pair) {
-  std::string res;
-  res += '(';
-  if constexpr (Eden::could_to_string<T>) {
-    res += std::to_string(pair.first);
-  } else {
-    res += [&] {
-      std::ostringstream oss;
-      oss << pair.first;
-      return oss.str();
-    }();
-  }
-  res += ", ";
-  if constexpr (Eden::could_to_string<U>) {
-    res += std::to_string(pair.second);
-  } else {
-    res += [&] {
-      std::ostringstream oss;
-      oss << pair.second;
-      return oss.str();
-    }();
-  }
-  res += ')';
-  return res;
+  Eden::memory_buffer<> buffer{};
+  Eden::to_string_to(buffer, pair);
+  return Eden::to_string(buffer);
 }
 
 }  // namespace std
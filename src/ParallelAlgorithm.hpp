@@ -0,0 +1,438 @@
+/**
+ * @file ParallelAlgorithm.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief data-parallel algorithms on top of `Eden::ThreadPool`
+ * @version 0.1
+ * @date 2023-02-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace Eden {
+
+/**
+ * @brief how a parallel loop splits its range into chunks
+ *
+ */
+enum class ChunkSchedule {
+  /// @brief one equal chunk per participant (cheapest, for uniform work)
+  static_partition,
+  /// @brief chunks shrink as the range drains (`remaining / 2p`)
+  guided,
+  /// @brief every participant tunes its own chunk size by timing its chunks
+  adaptive,
+};
+
+/**
+ * @brief options shared by all the parallel algorithms
+ *
+ */
+struct ParallelOptions {
+  /// @brief how to split the range
+  ChunkSchedule schedule = ChunkSchedule::adaptive;
+
+  /// @brief (minimum) chunk size, `0` => chosen from the range size
+  std::size_t grainSize = 0;
+
+  /// @brief ranges up to this size run inline on the calling thread
+  std::size_t inlineThreshold = 2048;
+};
+
+namespace detail {
+
+/**
+ * @brief shared state of one parallel loop
+ *
+ *        Helpers are queued on the pool and may start after the loop is
+ *        over, so this lives in a `shared_ptr` and helpers only touch the
+ *        caller's stack while they are counted in `inFlight`.
+ *
+ */
+struct LoopState {
+  LoopState(std::size_t total, std::size_t participants,
+            const ParallelOptions &options)
+      : total(total), participants(participants), options(options) {}
+
+  /// @brief claim the next chunk of about `want` items
+  bool claim(std::size_t want, std::size_t &begin, std::size_t &end) {
+    begin = cursor.fetch_add(want, std::memory_order_relaxed);
+    if (begin >= total) [[unlikely]] {
+      return false;
+    }
+    end = std::min(begin + want, total);
+    return true;
+  }
+
+  [[nodiscard]] bool exhausted() const {
+    return cursor.load(std::memory_order_seq_cst) >= total;
+  }
+
+  /// @brief remember the first exception and stop handing out chunks
+  void fail(std::exception_ptr err) {
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error) {
+        error = std::move(err);
+      }
+    }
+    cursor.store(total, std::memory_order_relaxed);
+  }
+
+  void leave() {
+    if (inFlight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      inFlight.notify_all();
+    }
+  }
+
+  /// @brief wait until every participant which got in has left
+  void wait_in_flight() {
+    for (auto n = inFlight.load(std::memory_order_acquire); n != 0;
+         n = inFlight.load(std::memory_order_acquire)) [[unlikely]] {
+      inFlight.wait(n, std::memory_order_acquire);
+    }
+  }
+
+  const std::size_t total;
+  const std::size_t participants;
+  const ParallelOptions options;
+
+  std::atomic<std::size_t> cursor = 0;
+  std::atomic<std::size_t> inFlight = 0;
+  std::mutex errorMutex;
+  std::exception_ptr error;
+};
+
+/**
+ * @brief per-participant chunk size policy (see `ChunkSchedule`)
+ *
+ */
+class ChunkSizer {
+  using clock = std::chrono::steady_clock;
+
+  /// @brief `adaptive` aims at chunks of roughly this duration
+  static constexpr auto target = std::chrono::microseconds{50};
+
+ public:
+  explicit ChunkSizer(const LoopState &state)
+      : state(state), grain(initial_grain(state)), size(grain) {}
+
+  /// @brief size of the next chunk to claim
+  std::size_t next() {
+    switch (state.options.schedule) {
+      case ChunkSchedule::static_partition:
+        return size;
+      case ChunkSchedule::guided: {
+        auto claimed = state.cursor.load(std::memory_order_relaxed);
+        auto remaining = claimed < state.total ? state.total - claimed : 0;
+        return std::max(grain, remaining / (2 * state.participants));
+      }
+      case ChunkSchedule::adaptive:
+        started = clock::now();
+        return size;
+    }
+    return size;
+  }
+
+  /// @brief report that the last chunk is done (only `adaptive` cares)
+  void done() {
+    if (state.options.schedule != ChunkSchedule::adaptive) [[likely]] {
+      return;
+    }
+    auto spent = clock::now() - started;
+    if (spent < target / 2) {
+      size *= 2;
+    } else if (spent > target * 2 && size > grain) {
+      size = std::max(grain, size / 2);
+    }
+  }
+
+ private:
+  static std::size_t initial_grain(const LoopState &state) {
+    if (state.options.grainSize != 0) {
+      return state.options.grainSize;
+    }
+    if (state.options.schedule == ChunkSchedule::static_partition) {
+      return (state.total + state.participants - 1) / state.participants;
+    }
+    return std::max<std::size_t>(1, state.total / (state.participants * 64));
+  }
+
+  const LoopState &state;
+  const std::size_t grain;
+  std::size_t size;
+  clock::time_point started{};
+};
+
+/**
+ * @brief run `participant(state)` on the caller and on up to
+ *        `threads_num() - 1` helpers, and return once all chunks are done
+ *
+ *        `participant` keeps claiming chunks from `state` until none is
+ *        left. The caller always participates, so a loop started from
+ *        inside a worker cannot deadlock the pool.
+ *
+ * @tparam Participant
+ * @param pool
+ * @param total
+ * @param options
+ * @param participant
+ */
+template <typename Participant>
+void run_participants(ThreadPool &pool, std::size_t total,
+                      const ParallelOptions &options,
+                      Participant &participant) {
+  auto grain = std::max<std::size_t>(options.grainSize, 1);
+  auto participants =
+      std::max<std::size_t>(1, std::min(pool.threads_num(), total / grain));
+  auto state = std::make_shared<LoopState>(total, participants, options);
+
+  auto enter = [](LoopState &self, Participant &body) {
+    self.inFlight.fetch_add(1, std::memory_order_seq_cst);
+    if (self.exhausted()) [[unlikely]] {
+      // too late, the caller may be gone => never touch `body`
+      self.leave();
+      return;
+    }
+    try {
+      body(self);
+    } catch (...) {
+      self.fail(std::current_exception());
+    }
+    self.leave();
+  };
+
+  for (std::size_t i = 1; i < participants; ++i) [[likely]] {
+    pool.submit_detached(
+        [state, body = &participant, enter]() { enter(*state, *body); });
+  }
+  enter(*state, participant);
+  state->wait_in_flight();
+  if (state->error) [[unlikely]] {
+    std::rethrow_exception(state->error);
+  }
+}
+
+/**
+ * @brief call `body(chunk_begin, chunk_end)` for chunks covering `[0, total)`
+ *
+ * @tparam Body
+ * @param pool
+ * @param total
+ * @param body
+ * @param options
+ */
+template <typename Body>
+void for_each_chunk(ThreadPool &pool, std::size_t total, Body &&body,
+                    const ParallelOptions &options) {
+  if (total <= options.inlineThreshold || pool.threads_num() <= 1) {
+    if (total != 0) {
+      body(std::size_t{0}, total);
+    }
+    return;
+  }
+  auto participant = [&body](LoopState &state) {
+    ChunkSizer sizer{state};
+    std::size_t begin{};
+    std::size_t end{};
+    while (state.claim(sizer.next(), begin, end)) [[likely]] {
+      body(begin, end);
+      sizer.done();
+    }
+  };
+  run_participants(pool, total, options, participant);
+}
+
+}  // namespace detail
+
+/**
+ * @brief call `func(i)` for every `i` in `[begin, end)` (integers), or
+ *        `func(*it)` for every `it` in `[begin, end)` (random-access iterators)
+ *
+ * @code
+    Eden::parallel_for(pool, 0, 1'000'000, [&](int i) { out[i] = i * i; });
+ * @endcode
+ *
+ * @tparam Index
+ * @tparam Func
+ * @param pool
+ * @param begin
+ * @param end
+ * @param func
+ * @param options
+ */
+template <typename Index, typename Func>
+  requires std::integral<Index> || std::random_access_iterator<Index>
+void parallel_for(ThreadPool &pool, Index begin, Index end, Func &&func,
+                  const ParallelOptions &options = {}) {
+  if (!(begin < end)) [[unlikely]] {
+    return;
+  }
+  auto total = static_cast<std::size_t>(end - begin);
+  detail::for_each_chunk(
+      pool, total,
+      [&](std::size_t lo, std::size_t hi) {
+        for (auto i = lo; i < hi; ++i) [[likely]] {
+          if constexpr (std::integral<Index>) {
+            func(static_cast<Index>(begin + static_cast<Index>(i)));
+          } else {
+            func(begin[static_cast<std::iter_difference_t<Index>>(i)]);
+          }
+        }
+      },
+      options);
+}
+
+/**
+ * @brief `*(d_first + i) = func(*(first + i))` for every element, in parallel
+ *
+ * @return OutIt past the last written element
+ */
+template <std::random_access_iterator InIt, std::random_access_iterator OutIt,
+          typename Func>
+OutIt parallel_transform(ThreadPool &pool, InIt first, InIt last, OutIt d_first,
+                         Func &&func, const ParallelOptions &options = {}) {
+  auto total = static_cast<std::size_t>(std::distance(first, last));
+  detail::for_each_chunk(
+      pool, total,
+      [&](std::size_t lo, std::size_t hi) {
+        using diff = std::iter_difference_t<InIt>;
+        std::transform(first + static_cast<diff>(lo),
+                       first + static_cast<diff>(hi),
+                       d_first + static_cast<diff>(lo), func);
+      },
+      options);
+  return d_first + static_cast<std::iter_difference_t<OutIt>>(total);
+}
+
+/**
+ * @brief reduce `[first, last)` with `op`, starting from `init`
+ *
+ * @attention Like `std::reduce`, the order of the operations is unspecified,
+ * so `op` should be associative and commutative.
+ *
+ * @return T
+ */
+template <std::random_access_iterator It, typename T,
+          typename BinaryOp = std::plus<>>
+T parallel_reduce(ThreadPool &pool, It first, It last, T init,
+                  BinaryOp op = {}, const ParallelOptions &options = {}) {
+  auto total = static_cast<std::size_t>(std::distance(first, last));
+  if (total <= options.inlineThreshold || pool.threads_num() <= 1) {
+    return std::accumulate(first, last, std::move(init), op);
+  }
+  std::mutex resultMutex;
+  std::optional<T> result{};
+  auto participant = [&](detail::LoopState &state) {
+    detail::ChunkSizer sizer{state};
+    std::optional<T> local{};
+    std::size_t lo{};
+    std::size_t hi{};
+    while (state.claim(sizer.next(), lo, hi)) [[likely]] {
+      for (auto i = lo; i < hi; ++i) [[likely]] {
+        auto &&value = first[static_cast<std::iter_difference_t<It>>(i)];
+        local = local ? op(std::move(*local), value) : T(value);
+      }
+      sizer.done();
+    }
+    if (local) {
+      std::lock_guard<std::mutex> lock(resultMutex);
+      result = result ? op(std::move(*result), std::move(*local))
+                      : std::move(*local);
+    }
+  };
+  detail::run_participants(pool, total, options, participant);
+  return result ? op(std::move(init), std::move(*result)) : init;
+}
+
+/**
+ * @brief inclusive scan of `[first, last)` with `op` into `d_first`
+ *
+ *        Two parallel passes over blocks: block totals first, then every
+ *        block is scanned again starting from the sum of its predecessors.
+ *
+ * @attention `op` must be associative.
+ *
+ * @return OutIt past the last written element
+ */
+template <std::random_access_iterator InIt, std::random_access_iterator OutIt,
+          typename BinaryOp = std::plus<>>
+OutIt parallel_scan(ThreadPool &pool, InIt first, InIt last, OutIt d_first,
+                    BinaryOp op = {}, const ParallelOptions &options = {}) {
+  using value_type = std::iter_value_t<InIt>;
+  using diff = std::iter_difference_t<InIt>;
+  auto total = static_cast<std::size_t>(std::distance(first, last));
+  if (total <= options.inlineThreshold || pool.threads_num() <= 1) {
+    return std::inclusive_scan(first, last, d_first, op);
+  }
+  // a few blocks per worker keeps both passes balanced
+  const std::size_t block_num = std::min(total, pool.threads_num() * 4);
+  const std::size_t block = (total + block_num - 1) / block_num;
+  const ParallelOptions per_block{.schedule = ChunkSchedule::adaptive,
+                                  .grainSize = 1,
+                                  .inlineThreshold = 0};
+
+  // 1. the total of every block
+  std::vector<std::optional<value_type>> sums(block_num);
+  parallel_for(
+      pool, std::size_t{0}, block_num,
+      [&](std::size_t b) {
+        auto lo = first + static_cast<diff>(std::min(b * block, total));
+        auto hi = first + static_cast<diff>(std::min((b + 1) * block, total));
+        if (lo != hi) {
+          sums[b] = std::accumulate(std::next(lo), hi, value_type(*lo), op);
+        }
+      },
+      per_block);
+
+  // 2. turn the totals into the carry of every block (sequential, tiny)
+  std::vector<std::optional<value_type>> carries(block_num);
+  for (std::size_t b = 1; b < block_num; ++b) {
+    carries[b] = carries[b - 1] ? op(*carries[b - 1], *sums[b - 1])
+                                : sums[b - 1];
+  }
+
+  // 3. scan every block again, starting from its carry
+  parallel_for(
+      pool, std::size_t{0}, block_num,
+      [&](std::size_t b) {
+        auto lo = std::min(b * block, total);
+        auto hi = std::min((b + 1) * block, total);
+        if (lo == hi) {
+          return;
+        }
+        auto out = d_first + static_cast<diff>(lo);
+        if (carries[b]) {
+          std::inclusive_scan(first + static_cast<diff>(lo),
+                              first + static_cast<diff>(hi), out, op,
+                              *carries[b]);
+        } else {
+          std::inclusive_scan(first + static_cast<diff>(lo),
+                              first + static_cast<diff>(hi), out, op);
+        }
+      },
+      per_block);
+  return d_first + static_cast<std::iter_difference_t<OutIt>>(total);
+}
+
+}  // namespace Eden
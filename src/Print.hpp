@@ -16,6 +16,7 @@
 #include <cstdio>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <list>
 #include <queue>
 #include <stdexcept>
@@ -25,6 +26,7 @@
 
 #include "Concepts.hpp"
 #include "Format.hpp"
+#include "Format/format_buffer.hpp"
 
 // print("{}", 1);
 //   => 1
@@ -55,8 +57,9 @@ namespace Eden {
 template <typename... Args>
 void print(const std::string_view fmt_str, Args &&...args) {
   auto fmt_args{std::make_format_args(std::forward<Args>(args)...)};
-  std::string out_str{std::vformat(fmt_str, fmt_args)};
-  fputs(out_str.c_str(), stdout);
+  memory_buffer<> out_buf{};
+  std::vformat_to(std::back_inserter(out_buf), fmt_str, fmt_args);
+  fwrite(out_buf.data(), 1, out_buf.size(), stdout);
 }
 void print() {}
 
@@ -70,16 +73,18 @@ void print() {}
 template <typename... Args>
 void println(const std::string_view fmt_str, Args &&...args) {
   auto fmt_args{std::make_format_args(std::forward<Args>(args)...)};
-  std::string out_str{std::vformat(fmt_str, fmt_args)};
-  fputs(out_str.c_str(), stdout);
-  fputs("\n", stdout);
+  memory_buffer<> out_buf{};
+  std::vformat_to(std::back_inserter(out_buf), fmt_str, fmt_args);
+  out_buf.push_back('\n');
+  fwrite(out_buf.data(), 1, out_buf.size(), stdout);
 }
 void println() { fputs("\n", stdout); }
 
 #else
 
 /**
- * @brief print `fmt` with `args...` (by using `oss_obj_operative_format`)
+ * @brief print `fmt` with `args...` (each arg written like `Eden::format`
+ * writes it)
  *
  * @tparam Args
  * @param fmt
@@ -87,13 +92,16 @@ void println() { fputs("\n", stdout); }
  */
 template <typename... Args>
 void print(const std::string_view fmt, Args &&...args) {
-  std::cout << oss_obj_operative_format(fmt, std::forward<Args>(args)...);
+  auto fmt_args = make_format_args(args...);
+  memory_buffer<> out_buf{};
+  vformat_to(out_buf, fmt, fmt_args);
+  std::cout.write(out_buf.data(), static_cast<std::streamsize>(out_buf.size()));
 }
 void print() {}
 
 /**
- * @brief print `fmt` with `args...` and a newline (by using
- * `oss_obj_operative_format`)
+ * @brief print `fmt` with `args...` and a newline (each arg written like
+ * `Eden::format` writes it)
  *
  * @tparam Args
  * @param fmt
@@ -101,8 +109,11 @@ void print() {}
  */
 template <typename... Args>
 void println(const std::string_view fmt, Args &&...args) {
-  std::cout << oss_obj_operative_format(fmt, std::forward<Args>(args)...);
-  std::cout << "\n";
+  auto fmt_args = make_format_args(args...);
+  memory_buffer<> out_buf{};
+  vformat_to(out_buf, fmt, fmt_args);
+  out_buf.push_back('\n');
+  std::cout.write(out_buf.data(), static_cast<std::streamsize>(out_buf.size()));
 }
 void println() { std::cout << "\n"; }
 
@@ -0,0 +1,328 @@
+/**
+ * @file Strand.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief serial executors (strands) running on `Eden::ThreadPool`
+ * @version 0.1
+ * @date 2023-02-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace Eden {
+
+/**
+ * @brief Runs the tasks posted to it one at a time, in posting order, on
+ *        any worker of a pool.
+ *
+ *        No thread is dedicated to the strand and nothing blocks: posting
+ *        is one lock-free push, and the first task posted to an idle strand
+ *        queues a drain on the pool, which runs the posted tasks back to
+ *        back (re-queuing itself every `batch_size` tasks so a busy strand
+ *        does not hog its worker). State touched by a strand's tasks only
+ *        needs no mutex.
+ *
+ * @code
+    Eden::Strand session{pool};
+    for (auto &message : inbox) {
+      session.post([&state, message] { state.apply(message); });
+    }
+ * @endcode
+ *
+ * @attention The pool must outlive the tasks posted. The strand itself may
+ * go first (its queued tasks still run), except when its `executor()` is
+ * still used (e.g. by futures bound to it).
+ *
+ */
+class Strand {
+ public:
+  /// @brief tasks run by one drain before it yields its worker
+  static constexpr std::size_t batch_size = 64;
+
+  explicit Strand(ThreadPool &pool) : state(std::make_shared<State>(pool)) {}
+
+  /**
+   * @brief run `task` after every task posted before it
+   *
+   * @attention Just like `ThreadPool::submit_detached()`, an exception
+   * escaping `task` calls `std::terminate()`.
+   *
+   * @tparam T
+   * @param task
+   */
+  template <typename T>
+  void post(T task) {
+    state->post([task = std::move(task)]() mutable noexcept { task(); });
+  }
+
+  /**
+   * @brief `post(task)` and get an `Eden::Future` of its result
+   *        (bound to the strand, so its `then()` continuations are
+   *        serialized with the strand's tasks)
+   *
+   * @tparam T
+   * @param task
+   * @return Future<std::invoke_result_t<T &>>
+   */
+  template <typename T>
+  auto submit(T task) -> Future<std::invoke_result_t<T &>> {
+    Promise<std::invoke_result_t<T &>> promise{};
+    auto future = promise.get_future();
+    state->post([promise = std::move(promise), task = std::move(task)]() mutable {
+      promise.set_result_of(task);
+    });
+    return std::move(future).via(executor());
+  }
+
+  /**
+   * @brief a handle posting tasks to this strand
+   *        (e.g. for `Future::via()`)
+   *
+   * @return ExecutorRef
+   */
+  [[nodiscard]] ExecutorRef executor() const noexcept {
+    return {state.get(), [](void *strand, UniqueTask task) {
+              static_cast<State *>(strand)->post(std::move(task));
+            }};
+  }
+
+  /// @brief whether the calling thread is running a task of this strand
+  [[nodiscard]] bool running_in_this_thread() const noexcept {
+    return current == state.get();
+  }
+
+  /// @brief the pool running the strand
+  [[nodiscard]] ThreadPool &pool() const noexcept { return state->pool; }
+
+ private:
+  /**
+   * @brief the queue of the strand (shared with the queued drain)
+   *
+   *        An intrusive MPSC list (Vyukov's): producers swap themselves in
+   *        at `head`, the single drain pops at `tail`. `count` tells the
+   *        producer whether a drain is already on its way.
+   *
+   */
+  struct State : std::enable_shared_from_this<State> {
+    struct Node {
+      UniqueTask task{};
+      std::atomic<Node *> next = nullptr;
+    };
+
+    explicit State(ThreadPool &pool) : pool(pool), head(&stub), tail(&stub) {}
+
+    ~State() {
+      // (only reached once no drain is queued => the list is empty)
+      while (auto *node = pop()) {
+        free_node(node);
+      }
+    }
+
+    void post(UniqueTask task) {
+      auto *node = make_node(std::move(task));
+      push(node);
+      if (count.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        schedule();
+      }
+    }
+
+    /**
+     * @brief queue a drain on the pool (the caller has the drain's role)
+     *
+     *        If the pool refuses it (it is stopped), no drain will ever come:
+     *        the tasks linked so far are dropped, so that `count` gets back
+     *        to 0 and the next post tries again (instead of queuing behind a
+     *        drain which never runs).
+     *
+     */
+    void schedule() {
+      try {
+        pool.submit_detached([self = shared_from_this()]() { self->drain(); });
+      } catch (...) {
+        discard();
+        throw;
+      }
+    }
+
+    /// @brief run up to `batch_size` tasks, then hand over (or go idle)
+    void drain() {
+      struct Leave {
+        const State *outer;
+        ~Leave() { current = outer; }
+      } leave{std::exchange(current, this)};
+      std::size_t ran = 0;
+      while (ran < batch_size) [[likely]] {
+        auto *node = pop_linked();
+        try {
+          node->task();
+        } catch (...) {
+          // done with it all the same => the strand goes on, then the
+          // exception goes to the pool (e.g. a task of `executor()`)
+          free_node(node);
+          if (count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            schedule();
+          }
+          throw;
+        }
+        free_node(node);
+        ++ran;
+        if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          return;
+        }
+      }
+      // more to do => back to the end of the pool's queue
+      schedule();
+    }
+
+    /// @brief (in place of a drain) drop the tasks until `count` is 0
+    void discard() noexcept {
+      do {
+        free_node(pop_linked());
+      } while (count.fetch_sub(1, std::memory_order_acq_rel) != 1);
+    }
+
+    /// @brief (drain only) pop the oldest node, waiting for a counted one
+    ///        to be linked
+    Node *pop_linked() {
+      auto *node = pop();
+      while (node == nullptr) [[unlikely]] {
+        // counted but not linked yet (a producer between its two steps)
+        std::this_thread::yield();
+        node = pop();
+      }
+      return node;
+    }
+
+    /// @brief nodes come from the thread-local free lists of the futures
+    ///        (freed on the draining thread, reused by its next posts)
+    static Node *make_node(UniqueTask task) {
+      auto *node = ::new (detail::StatePool::allocate(sizeof(Node))) Node{};
+      node->task = std::move(task);
+      return node;
+    }
+
+    static void free_node(Node *node) noexcept {
+      node->~Node();
+      detail::StatePool::deallocate(node, sizeof(Node));
+    }
+
+    void push(Node *node) {
+      // (the stub is pushed again and again)
+      node->next.store(nullptr, std::memory_order_relaxed);
+      auto *prev = head.exchange(node, std::memory_order_acq_rel);
+      prev->next.store(node, std::memory_order_release);
+    }
+
+    /// @brief (drain only) pop the oldest node (`nullptr` if none is linked)
+    Node *pop() {
+      auto *first = tail;
+      auto *next = first->next.load(std::memory_order_acquire);
+      if (first == &stub) {
+        if (next == nullptr) {
+          return nullptr;
+        }
+        // skip the stub
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+      }
+      if (next != nullptr) [[likely]] {
+        tail = next;
+        return first;
+      }
+      if (first != head.load(std::memory_order_acquire)) {
+        // a producer is between its two steps
+        return nullptr;
+      }
+      // `first` is the last node => put the stub behind it to pop it
+      push(&stub);
+      next = first->next.load(std::memory_order_acquire);
+      if (next != nullptr) [[likely]] {
+        tail = next;
+        return first;
+      }
+      return nullptr;
+    }
+
+    ThreadPool &pool;
+    /// @brief tasks posted and not run yet (> 0 <=> a drain is queued)
+    std::atomic<std::size_t> count = 0;
+    Node stub{};
+    /// @brief last node (producers)
+    std::atomic<Node *> head;
+    /// @brief oldest node (drain only)
+    Node *tail;
+  };
+
+  /// @brief the strand whose task runs on this thread (`nullptr` if none)
+  static inline thread_local const State *current = nullptr;
+
+  std::shared_ptr<State> state;
+};
+
+/**
+ * @brief Serializes tasks by key over a fixed set of strands.
+ *
+ *        Tasks of one key run one at a time and in posting order; tasks of
+ *        different keys run in parallel unless their keys share a strand
+ *        (which only costs parallelism, never ordering). Nothing is
+ *        allocated per key.
+ *
+ * @tparam Key
+ * @tparam Hash
+ */
+template <typename Key, typename Hash = std::hash<Key>>
+class KeyedStrands {
+ public:
+  /// @brief `strandNum == 0` => 4 strands per worker of `pool`
+  explicit KeyedStrands(ThreadPool &pool, std::size_t strandNum = 0,
+                        Hash hash = Hash{})
+      : hash(std::move(hash)) {
+    if (strandNum == 0) {
+      strandNum = 4 * std::max<std::size_t>(pool.threads_num(), 1);
+    }
+    strands.reserve(strandNum);
+    for (std::size_t i = 0; i < strandNum; ++i) [[likely]] {
+      strands.emplace_back(pool);
+    }
+  }
+
+  /// @brief `Strand::post()` on the strand of `key`
+  template <typename T>
+  void post(const Key &key, T task) {
+    strand_for(key).post(std::move(task));
+  }
+
+  /// @brief `Strand::submit()` on the strand of `key`
+  template <typename T>
+  auto submit(const Key &key, T task) -> Future<std::invoke_result_t<T &>> {
+    return strand_for(key).submit(std::move(task));
+  }
+
+  /// @brief the strand serializing `key`
+  [[nodiscard]] Strand &strand_for(const Key &key) {
+    return strands[hash(key) % strands.size()];
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return strands.size(); }
+
+ private:
+  Hash hash;
+  std::vector<Strand> strands{};
+};
+
+}  // namespace Eden
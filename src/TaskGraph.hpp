@@ -0,0 +1,350 @@
+/**
+ * @file TaskGraph.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief reusable task graph (DAG) running on `Eden::ThreadPool`
+ * @version 0.1
+ * @date 2023-02-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace Eden {
+
+/**
+ * @brief A DAG of tasks declared once and run as many times as needed.
+ *
+ *        Every run gets its own dependency counters, so a node is dispatched
+ *        the moment its last predecessor finishes, without anybody waiting:
+ *        the first successor made ready runs right away on the same worker,
+ *        the others are queued on the pool. A node could also run a whole
+ *        other graph (`compose()`), which is how subgraphs are reused.
+ *
+ * @code
+    Eden::TaskGraph graph{};
+    auto load = graph.emplace([] { load_input(); });
+    auto left = graph.emplace([] { filter_left(); });
+    auto right = graph.emplace([] { filter_right(); });
+    auto merge = graph.emplace([] { merge_both(); });
+    load.precede(left, right);
+    merge.succeed(left, right);
+    for (auto frame = 0; frame < 100; ++frame) {
+      graph.run(pool).get();
+    }
+ * @endcode
+ *
+ * @attention The graph must not be modified while running, and must outlive
+ * its runs (as must the composed graphs and the pool).
+ *
+ */
+class TaskGraph {
+ public:
+  /**
+   * @brief handle of a node, used to declare its edges
+   *
+   */
+  class Node {
+   public:
+    /// @brief `this` runs before every node of `successors`
+    template <typename... Nodes>
+    Node &precede(const Nodes &...successors) {
+      (graph->add_edge(index, successors.index), ...);
+      return *this;
+    }
+
+    /// @brief `this` runs after every node of `predecessors`
+    template <typename... Nodes>
+    Node &succeed(const Nodes &...predecessors) {
+      (graph->add_edge(predecessors.index, index), ...);
+      return *this;
+    }
+
+    /// @brief position of the node in its graph
+    [[nodiscard]] std::size_t id() const noexcept { return index; }
+
+   private:
+    friend class TaskGraph;
+
+    Node(TaskGraph *graph, std::size_t index) : graph(graph), index(index) {}
+
+    TaskGraph *graph;
+    std::size_t index;
+  };
+
+  TaskGraph() = default;
+
+  /// @brief add a node running `func` (called once per run)
+  template <typename F>
+  Node emplace(F func) {
+    nodes.emplace_back();
+    nodes.back().work = std::move(func);
+    validated = false;
+    return Node{this, nodes.size() - 1};
+  }
+
+  /// @brief add a node running the whole of `subgraph` (once per run)
+  Node compose(TaskGraph &subgraph) {
+    if (&subgraph == this) [[unlikely]] {
+      throw std::invalid_argument("a TaskGraph cannot compose itself");
+    }
+    nodes.emplace_back();
+    nodes.back().subgraph = &subgraph;
+    validated = false;
+    return Node{this, nodes.size() - 1};
+  }
+
+  /**
+   * @brief run the graph once on `pool`
+   *
+   *        The first exception thrown by a node (or by the pool refusing
+   *        one) is stored in the returned future. The nodes not started yet
+   *        are skipped then, but the run still goes through the whole graph
+   *        before completing.
+   *
+   * @param pool
+   * @return Future<void> bound to `pool` (ready once every node is done)
+   */
+  Future<void> run(ThreadPool &pool) {
+    std::vector<const TaskGraph *> composing{};
+    validate(composing);
+    return start(pool);
+  }
+
+  /// @brief number of nodes
+  [[nodiscard]] std::size_t size() const noexcept { return nodes.size(); }
+
+  [[nodiscard]] bool empty() const noexcept { return nodes.empty(); }
+
+  /// @brief remove every node (and edge)
+  void clear() {
+    nodes.clear();
+    sources.clear();
+    validated = false;
+  }
+
+  // copy constructor and copy assignment operator are deleted
+  // (nodes hold move-only callables, and handles point to their graph)
+  TaskGraph(const TaskGraph &copied) = delete;
+  TaskGraph &operator=(const TaskGraph &copied) = delete;
+
+ private:
+  static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  /// @brief `run()` without validation (the graph and its subgraphs are)
+  Future<void> start(ThreadPool &pool) {
+    auto state = std::make_shared<Run>(*this, pool);
+    auto done = state->promise.get_future().via(pool.executor());
+    if (nodes.empty()) [[unlikely]] {
+      state->promise.set_value();
+      return done;
+    }
+    for (auto source : sources) [[likely]] {
+      dispatch(state, source);
+    }
+    return done;
+  }
+
+  struct NodeData {
+    /// @brief what the node runs (empty when it composes a subgraph)
+    UniqueTask work{};
+    /// @brief the composed graph (`nullptr` for a plain node)
+    TaskGraph *subgraph = nullptr;
+    /// @brief nodes waiting for this one
+    std::vector<std::size_t> successors{};
+    /// @brief number of nodes this one waits for
+    std::size_t predecessors = 0;
+  };
+
+  /**
+   * @brief state of one run (shared by all its queued nodes)
+   *
+   */
+  struct Run {
+    Run(TaskGraph &graph, ThreadPool &pool)
+        : graph(graph),
+          pool(pool),
+          pending(std::make_unique<std::atomic<std::size_t>[]>(
+              graph.nodes.size())),
+          remaining(graph.nodes.size()) {
+      for (std::size_t i = 0; i < graph.nodes.size(); ++i) [[likely]] {
+        pending[i].store(graph.nodes[i].predecessors,
+                         std::memory_order_relaxed);
+      }
+    }
+
+    /// @brief keep the first error (only its writer touches `error`)
+    void fail(std::exception_ptr caught) noexcept {
+      if (!failed.exchange(true, std::memory_order_acq_rel)) {
+        error = std::move(caught);
+      }
+    }
+
+    TaskGraph &graph;
+    ThreadPool &pool;
+    /// @brief predecessors not finished yet, per node
+    std::unique_ptr<std::atomic<std::size_t>[]> pending;
+    /// @brief nodes not finished yet
+    std::atomic<std::size_t> remaining;
+    /// @brief whether a node threw (=> skip the rest)
+    std::atomic<bool> failed = false;
+    std::exception_ptr error{};
+    Promise<void> promise{};
+  };
+
+  void add_edge(std::size_t from, std::size_t to) {
+    if (from >= nodes.size() || to >= nodes.size()) [[unlikely]] {
+      throw std::out_of_range("TaskGraph edge between unknown nodes");
+    }
+    nodes[from].successors.emplace_back(to);
+    ++nodes[to].predecessors;
+    validated = false;
+  }
+
+  /**
+   * @brief find the sources and reject cycles (once per modification), in
+   *        this graph and every composed one, before anything runs
+   *
+   * @param composing the graphs composing this one (to reject a graph
+   * composing itself through others)
+   */
+  void validate(std::vector<const TaskGraph *> &composing) {
+    if (std::find(composing.begin(), composing.end(), this) !=
+        composing.end()) [[unlikely]] {
+      throw std::logic_error("TaskGraph composes itself");
+    }
+    composing.emplace_back(this);
+    for (auto &node : nodes) [[likely]] {
+      if (node.subgraph != nullptr) {
+        node.subgraph->validate(composing);
+      }
+    }
+    composing.pop_back();
+    if (validated) [[likely]] {
+      return;
+    }
+    sources.clear();
+    std::vector<std::size_t> indegree(nodes.size());
+    std::vector<std::size_t> ready{};
+    for (std::size_t i = 0; i < nodes.size(); ++i) [[likely]] {
+      indegree[i] = nodes[i].predecessors;
+      if (indegree[i] == 0) {
+        sources.emplace_back(i);
+        ready.emplace_back(i);
+      }
+    }
+    std::size_t visited = 0;
+    while (!ready.empty()) [[likely]] {
+      auto index = ready.back();
+      ready.pop_back();
+      ++visited;
+      for (auto next : nodes[index].successors) [[likely]] {
+        if (--indegree[next] == 0) {
+          ready.emplace_back(next);
+        }
+      }
+    }
+    if (visited != nodes.size()) [[unlikely]] {
+      throw std::logic_error("TaskGraph contains a cycle");
+    }
+    validated = true;
+  }
+
+  /// @brief run `index`, then whatever it made ready, on this thread
+  static void execute(const std::shared_ptr<Run> &state, std::size_t index) {
+    while (index != none) [[likely]] {
+      auto &node = state->graph.nodes[index];
+      if (node.subgraph != nullptr &&
+          !state->failed.load(std::memory_order_relaxed)) {
+        // finishes (and dispatches the successors) once the subgraph is done
+        node.subgraph->start(state->pool)
+            .then([state, index](Future<void> done) {
+              try {
+                done.get();
+              } catch (...) {
+                state->fail(std::current_exception());
+              }
+              execute(state, finish(state, index));
+            });
+        return;
+      }
+      if (node.work && !state->failed.load(std::memory_order_relaxed)) {
+        try {
+          node.work();
+        } catch (...) {
+          state->fail(std::current_exception());
+        }
+      }
+      index = finish(state, index);
+    }
+  }
+
+  /**
+   * @brief queue `index` on the pool, or, if the pool refuses it (e.g.
+   *        stopped, or its bounded queue full), fail the run and go through
+   *        `index` and what it makes ready on this thread, skipping their
+   *        work => every node is still finished, so the run completes
+   *
+   */
+  static void dispatch(const std::shared_ptr<Run> &state, std::size_t index) {
+    try {
+      state->pool.submit_detached([state, index]() { execute(state, index); });
+      return;
+    } catch (...) {
+      state->fail(std::current_exception());
+    }
+    execute(state, index);
+  }
+
+  /**
+   * @brief mark `index` as done and dispatch the successors it made ready
+   *
+   * @return the one successor to run inline next (`none` if none is ready)
+   */
+  static std::size_t finish(const std::shared_ptr<Run> &state,
+                            std::size_t index) {
+    std::size_t next = none;
+    for (auto successor : state->graph.nodes[index].successors) [[likely]] {
+      if (state->pending[successor].fetch_sub(1, std::memory_order_acq_rel) ==
+          1) {
+        if (next != none) {
+          dispatch(state, next);
+        }
+        next = successor;
+      }
+    }
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        [[unlikely]] {
+      if (state->failed.load(std::memory_order_acquire)) {
+        state->promise.set_exception(state->error);
+      } else {
+        state->promise.set_value();
+      }
+    }
+    return next;
+  }
+
+  /// @brief every node, indexed by `Node::id()`
+  std::vector<NodeData> nodes{};
+
+  /// @brief (valid once `validated`) nodes without predecessors
+  std::vector<std::size_t> sources{};
+
+  /// @brief whether `sources` is up to date and the graph is acyclic
+  bool validated = false;
+};
+
+}  // namespace Eden
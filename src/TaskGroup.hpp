@@ -0,0 +1,200 @@
+/**
+ * @file TaskGroup.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief structured group of tasks running on `Eden::ThreadPool`
+ * @version 0.1
+ * @date 2023-02-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "ThreadPool.hpp"
+
+namespace Eden {
+
+/**
+ * @brief Tasks spawned together, waited for together, cancelled together.
+ *
+ *        `wait()` on a worker of the pool does not block it: the worker runs
+ *        queued tasks (its group's first, since they sit in its own deque in
+ *        work-stealing mode) until the group is done, so recursive splits
+ *        never deadlock a small pool.
+ *
+ * @code
+    long fib(Eden::ThreadPool &pool, int n) {
+      if (n < 2) {
+        return n;
+      }
+      long left = 0;
+      Eden::TaskGroup group{pool};
+      group.spawn([&] { left = fib(pool, n - 1); });
+      auto right = fib(pool, n - 2);
+      group.wait();
+      return left + right;
+    }
+ * @endcode
+ *
+ * @attention The pool must outlive the group.
+ *
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool &pool)
+      : pool(pool), state(std::make_shared<State>()) {}
+
+  /**
+   * @brief run `func` on the pool as a part of the group
+   *
+   *        `func` may take a `std::stop_token` to poll `cancel()`. A task not
+   *        started before the group is cancelled is skipped, and the first
+   *        exception thrown by a task cancels the rest of the group.
+   *
+   * @tparam F
+   * @param func
+   */
+  template <typename F>
+  void spawn(F func) {
+    state->pending.fetch_add(1, std::memory_order_relaxed);
+    try {
+      pool.submit_detached([state = state, func = std::move(func)]() mutable {
+        run(*state, func);
+      });
+    } catch (...) {
+      state->finish();
+      throw;
+    }
+  }
+
+  /**
+   * @brief wait for every task spawned so far (and those they spawn), then
+   *        rethrow the first exception thrown by one of them, if any
+   *
+   *        On a worker of the pool, queued tasks are run meanwhile.
+   *
+   */
+  void wait() {
+    if (pool.is_worker_thread()) {
+      help_until_done();
+    } else {
+      for (auto left = state->pending.load(std::memory_order_acquire);
+           left != 0; left = state->pending.load(std::memory_order_acquire))
+          [[likely]] {
+        state->pending.wait(left, std::memory_order_acquire);
+      }
+    }
+    if (state->failed.load(std::memory_order_acquire)) [[unlikely]] {
+      // reported once (the group stays cancelled though)
+      auto error = std::exchange(state->error, nullptr);
+      state->failed.store(false, std::memory_order_relaxed);
+      std::rethrow_exception(error);
+    }
+  }
+
+  /// @brief skip the tasks not started yet, and ask the running ones to stop
+  ///        (through their `std::stop_token`)
+  void cancel() noexcept { state->source.request_stop(); }
+
+  [[nodiscard]] bool cancelled() const noexcept {
+    return state->source.stop_requested();
+  }
+
+  /// @brief the token given to the tasks (e.g. to poll from the outside)
+  [[nodiscard]] std::stop_token stop_token() const noexcept {
+    return state->source.get_token();
+  }
+
+  /// @brief waits for the group (an exception left unreported is dropped)
+  ~TaskGroup() {
+    try {
+      wait();
+    } catch (...) {
+      // nobody to report it to
+    }
+  }
+
+  // copy constructor and copy assignment operator are deleted
+  TaskGroup(const TaskGroup &copied) = delete;
+  TaskGroup &operator=(const TaskGroup &copied) = delete;
+
+ private:
+  /**
+   * @brief state shared with the queued tasks
+   *        (they may still touch it after `wait()` returned)
+   *
+   */
+  struct State {
+    /// @brief keep the first error and cancel the rest of the group
+    void fail(std::exception_ptr caught) noexcept {
+      if (!failed.exchange(true, std::memory_order_acq_rel)) {
+        error = std::move(caught);
+      }
+      source.request_stop();
+    }
+
+    /// @brief one task is done => wake the waiters on the last one
+    void finish() noexcept {
+      if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) [[unlikely]] {
+        pending.notify_all();
+      }
+    }
+
+    /// @brief tasks spawned and not done yet
+    std::atomic<std::size_t> pending = 0;
+    std::stop_source source{};
+    /// @brief whether a task threw (only its writer touches `error`)
+    std::atomic<bool> failed = false;
+    std::exception_ptr error{};
+  };
+
+  template <typename F>
+  static void run(State &state, F &func) noexcept {
+    if (!state.source.stop_requested()) [[likely]] {
+      try {
+        if constexpr (std::invocable<F &, std::stop_token>) {
+          func(state.source.get_token());
+        } else {
+          func();
+        }
+      } catch (...) {
+        state.fail(std::current_exception());
+      }
+    }
+    state.finish();
+  }
+
+  /// @brief (on a worker) run queued tasks until the group is done
+  void help_until_done() {
+    std::size_t misses = 0;
+    while (state->pending.load(std::memory_order_acquire) != 0) [[likely]] {
+      if (pool.run_pending_task()) [[likely]] {
+        misses = 0;
+        continue;
+      }
+      // the group's last tasks run on other workers => back off, but keep
+      // polling (blocking here could starve a task queued behind us)
+      if (++misses < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds{50});
+      }
+    }
+  }
+
+  ThreadPool &pool;
+  std::shared_ptr<State> state;
+};
+
+}  // namespace Eden
@@ -12,6 +12,8 @@
 #pragma once
 
 #include <functional>
+#include <iterator>
+#include <string>
 
 #include "../Format.hpp"
 #include "../Print.hpp"
@@ -52,7 +54,7 @@ void fib_seq_test() {
                 EOF_IDX - 1);
   std::string res_str{};
   for (auto &&res : fib_seq_res) {
-    res_str += Eden::format("{} ", res.get());
+    Eden::format_to(std::back_inserter(res_str), "{} ", res.get());
   }
   Eden::println("{}\n", res_str);
 }
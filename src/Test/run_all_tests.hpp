@@ -15,10 +15,18 @@
 #include <vector>
 
 #include "fib_seq.hpp"
+#include "test_coroutine.hpp"
 #include "test_backslash.hpp"
 #include "test_eprint.hpp"
+#include "test_format.hpp"
 #include "test_maybe.hpp"
+#include "test_mpmc_queue.hpp"
+#include "test_parallel_algorithm.hpp"
 #include "test_print.hpp"
+#include "test_strand.hpp"
+#include "test_task_graph.hpp"
+#include "test_task_group.hpp"
+#include "test_thread_pool.hpp"
 #include "test_tuple_utility.hpp"
 
 namespace Test {
@@ -27,9 +35,17 @@ static const std::vector<std::function<void()>> tests = {
     Test::test_print,
     // Test::test_backslash,
     Test::test_eprint,
+    Test::test_format,
     Test::test_tuple_utility,
     // Test::fib_seq_test,
     Test::test_maybe,
+    Test::test_mpmc_queue,
+    Test::test_thread_pool,
+    Test::test_parallel_algorithm,
+    Test::test_coroutine,
+    Test::test_task_graph,
+    Test::test_task_group,
+    Test::test_strand,
 };
 
 static void IKU_IKU_IKU_AH() {
@@ -0,0 +1,55 @@
+/**
+ * @file test_coroutine.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-06
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+
+#include "../Coroutine.hpp"
+#include "../Print.hpp"
+
+namespace Test {
+
+Eden::task<std::size_t> fib_on_pool(Eden::ThreadPool &pool, std::size_t n) {
+  co_await pool.schedule();
+  if (n < 2) {
+    co_return 1;
+  }
+  auto a = co_await fib_on_pool(pool, n - 1);
+  auto b = co_await fib_on_pool(pool, n - 2);
+  co_return a + b;
+}
+
+Eden::task<> throw_on_pool(Eden::ThreadPool &pool) {
+  co_await pool.schedule();
+  throw std::runtime_error{"thrown on a worker"};
+}
+
+void test_coroutine() {
+  Eden::ThreadPool pool{};
+
+  // continuations run on the pool, the caller only blocks in `sync_wait`
+  assert(Eden::sync_wait(fib_on_pool(pool, 10)) == 89);
+  assert(Eden::spawn(pool, fib_on_pool(pool, 10)).get() == 89);
+
+  try {
+    Eden::sync_wait(throw_on_pool(pool));
+    assert(false);
+  } catch (const std::runtime_error &) {
+  }
+
+  Eden::println("`test_coroutine()` passed!");
+  Eden::println();
+}
+
+}  // namespace Test
@@ -10,18 +10,28 @@
  */
 
 /**
- * @attention This file is @b DISCARDED due to `std_format_library` was found
- * So of course, the `eden_format_library` will be deprecated
+ * @attention `test_format()` only builds without `std_format_library` (which
+ * can't format a tuple / pair), so it only runs on the `eden_format_library`
+ * fallback. The other tests run on both.
  *
  */
 
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <ostream>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "../AdvancedPair.hpp"
 #include "../AdvancedTuple.hpp"
@@ -30,6 +40,187 @@
 
 namespace Test {
 
+void test_compiled_format() {
+  // parsed at compile time (a malformed literal doesn't compile)
+  assert("{} + {} = {}"_format(1, 2, 3) == "1 + 2 = 3");
+  assert("{1}, {0}"_fmt(1, 2) == "2, 1");
+  assert("{{{}}} {{}}"_f(7) == "{7} {}");
+  assert("{}: {}"_format("x", 1.5) == "x: 1.5");
+  assert("no placeholder"_format() == "no placeholder");
+  assert(""_format() == "");
+
+#if !__cpp_lib_format
+  // same pieces as the runtime parser
+  assert(Eden::format("{{{}}} {{}}", 7) == "{7} {}");
+  for (const char *malformed : {"{", "}", "{0", "{x}"}) {
+    try {
+      Eden::format(malformed, 1);
+      assert(false);
+    } catch (const std::runtime_error &) {
+    }
+  }
+  // an index past the last argument
+  try {
+    Eden::format("{} {3}", 1, 2);
+    assert(false);
+  } catch (const std::out_of_range &) {
+  }
+  assert(Eden::format("{1} {0} {}", 1, 2) == "2 1 1");
+#endif
+
+  Eden::println("`test_compiled_format()` passed!");
+  Eden::println();
+}
+
+/// @brief a user type (printed by its `operator<<`)
+struct Cell {
+  int row{};
+  int col{};
+  friend std::ostream &operator<<(std::ostream &os, const Cell &cell) {
+    return os << '[' << cell.row << "; " << cell.col << ']';
+  }
+};
+
+void test_format_args() {
+  using Eden::format;
+
+  // numbers => `std::to_chars` (floats in their shortest round-trip form)
+  assert(format("{} {}", INT64_MIN, UINT64_MAX) ==
+         "-9223372036854775808 18446744073709551615");
+  assert(format("{} {} {} {}", 0.1, 2.5F, 1e300, -0.0) ==
+         "0.1 2.5 1e+300 -0");
+  assert(format("{}", 0.30000000000000004) == "0.30000000000000004");
+  auto round_trip = 1.0 / 3;
+  assert(std::stod(format("{}", round_trip)) == round_trip);
+
+  // bool, char and strings as themselves, each arg on its own
+  std::string str{"str"};
+  std::string_view view{"view"};
+  const char *c_str = "c_str";
+  assert(format("{} {} {} {} {} {}", true, 'c', str, view, c_str, "lit") ==
+         "true c str view c_str lit");
+  assert(format("{}|{}|{}", 42, "mixed", 1.5) == "42|mixed|1.5");
+  assert("{}{}"_format(false, 7U) == "false7");
+
+#if !__cpp_lib_format
+  // user types => `operator<<`
+  assert(format("{} at {}", "p", Cell{1, 2}) == "p at [1; 2]");
+#endif
+
+  Eden::println("`test_format_args()` passed!");
+  Eden::println();
+}
+
+/// @brief a `std::string` counting the chars its `resize()` fills in
+struct filling_string {
+  using value_type = char;
+
+  std::string str{};
+  std::size_t filled = 0;
+
+  void push_back(char ch) { str.push_back(ch); }
+  char *data() { return str.data(); }
+  [[nodiscard]] std::size_t size() const { return str.size(); }
+  [[nodiscard]] std::size_t capacity() const { return str.capacity(); }
+  void resize(std::size_t size) {
+    filled += size > str.size() ? size - str.size() : 0;
+    str.resize(size);
+  }
+};
+
+void test_format_to() {
+  // appended in place
+  std::string line{"> "};
+  for (int i = 1; i <= 3; ++i) {
+    Eden::format_to(std::back_inserter(line), "{} ", i);
+  }
+  assert(line == "> 1 2 3 ");
+  std::string long_str(1000, 'x');
+  Eden::format_to(std::back_inserter(line), "[{}]", long_str);
+  assert(line.size() == 8 + 1002 && line.back() == ']');
+  std::vector<char> chars{};
+  Eden::format_to(std::back_inserter(chars), "{}{}", 4, 2);
+  assert(std::string(chars.begin(), chars.end()) == "42");
+
+  // appending in a loop doesn't touch the whole spare capacity every time
+  filling_string appended{};
+  appended.str.reserve(1 << 16);
+  static constexpr int APPENDS = 1000;
+  for (int i = 0; i < APPENDS; ++i) {
+    Eden::format_to(std::back_inserter(appended), "{} ", i);
+  }
+  assert(appended.str.size() == 3890 && appended.str.ends_with("999 "));
+  assert(appended.filled <= APPENDS * 128);
+
+  // a fixed array
+  char array[16]{};
+  auto *end = Eden::format_to(array, "{} + {}", 1, 2);
+  assert(std::string_view(array, end) == "1 + 2");
+  auto result = Eden::format_to_n(array, 3, "{}", 123456);
+  assert(result.out == array + 3 && result.size == 6);
+  assert(std::string_view(array, 3) == "123");
+
+  // any output iterator (flushed in chunks)
+  std::list<char> list{};
+  auto counted = Eden::format_to_n(std::back_inserter(list), 300, "{}{}",
+                                   long_str, long_str);
+  assert(list.size() == 300 && counted.size == 2000);
+  std::ostringstream oss{};
+  Eden::format_to(std::ostreambuf_iterator<char>{oss}, "{{{}}}", long_str);
+  assert(oss.str().size() == 1002);
+
+  assert(Eden::formatted_size("{}: {}", 10, 20) == 6);
+  assert(Eden::formatted_size("{}", long_str) == 1000);
+  assert(Eden::formatted_size("") == 0);
+
+  Eden::println("`test_format_to()` passed!");
+  Eden::println();
+}
+
+void test_memory_buffer() {
+  // counts the blocks asked for (the allocator hook)
+  struct counting_allocator : std::allocator<char> {
+    char *allocate(std::size_t count) {
+      ++*allocations;
+      return std::allocator<char>::allocate(count);
+    }
+    int *allocations;
+  };
+  int allocations = 0;
+
+  // inline as long as it fits
+  Eden::memory_buffer<16, counting_allocator> buffer{
+      counting_allocator{{}, &allocations}};
+  Eden::format_to(std::back_inserter(buffer), "{}-{}", 12, 34);
+  assert(buffer.view() == "12-34" && allocations == 0);
+
+  // then on the heap, growing geometrically
+  std::string long_str(100, 'x');
+  Eden::format_to(std::back_inserter(buffer), "{}", long_str);
+  assert(buffer.size() == 105 && allocations >= 1 && allocations <= 4);
+  assert(Eden::to_string(buffer) == "12-34" + long_str);
+
+  // moving takes the heap block, or copies the inline chars
+  auto moved = std::move(buffer);
+  assert(moved.size() == 105 && buffer.size() == 0);
+  Eden::memory_buffer<> small{};
+  small.push_back('a');
+  auto small_moved = std::move(small);
+  assert(small_moved.view() == "a" && small.size() == 0);
+
+  // the tuple / pair helpers write into it too
+  Eden::memory_buffer<> helpers{};
+  Eden::to_string_to(helpers, std::make_tuple(1, std::string{"two"}, 3));
+  Eden::to_string_to(helpers, std::make_pair(4, std::string{"c"}));
+  assert(helpers.view() == "(1, two, 3)(4, c)");
+  assert(std::to_string(std::make_pair(1, 2)) == "(1, 2)");
+
+  Eden::println("`test_memory_buffer()` passed!");
+  Eden::println();
+}
+
+#if !__cpp_lib_format
+
 void test_format() {
   using Eden::format;
   using Eden::println;
@@ -48,8 +239,37 @@ void test_format() {
   println("format(tuple) == format(pair)");
   println();
 
+  // written in place, element by element (nested ones too)
+  std::string long_str(300, 'x');
+  auto nested = std::make_tuple(1, std::make_pair(2.5, long_str), 'c', true);
+  std::string expected = "(1, (2.5, " + long_str + "), c, true)";
+  assert(format("{}", nested) == expected);
+  std::ostringstream streamed{};
+  streamed << std::boolalpha << nested;
+  assert(streamed.str() == expected);
+  Eden::memory_buffer<> nested_buffer{};
+  Eden::format_to(std::back_inserter(nested_buffer), "<{}>", nested);
+  assert(nested_buffer.view() == "<" + expected + ">");
+  assert(format("{}", std::make_pair(std::make_tuple(), 1)) == "((), 1)");
+
   println("`test_format()` passed!");
   println();
+
+  test_compiled_format();
+  test_format_args();
+  test_format_to();
+  test_memory_buffer();
 }
 
+#else
+
+void test_format() {
+  test_compiled_format();
+  test_format_args();
+  test_format_to();
+  test_memory_buffer();
+}
+
+#endif
+
 }  // namespace Test
\ No newline at end of file
@@ -0,0 +1,108 @@
+/**
+ * @file test_mpmc_queue.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../MPMCQueue.hpp"
+#include "../Print.hpp"
+
+namespace Test {
+
+/// @brief copying throws when `fail` is set (moving never does)
+struct ThrowingCopy {
+  static inline bool fail = false;
+
+  int value = 0;
+
+  ThrowingCopy() = default;
+  explicit ThrowingCopy(int value) : value(value) {}
+  ThrowingCopy(const ThrowingCopy &copied) : value(copied.value) {
+    if (fail) {
+      throw std::runtime_error("copy failed");
+    }
+  }
+  ThrowingCopy(ThrowingCopy &&moved) noexcept = default;
+  ThrowingCopy &operator=(const ThrowingCopy &copied) = default;
+  ThrowingCopy &operator=(ThrowingCopy &&moved) noexcept = default;
+};
+
+void test_mpmc_queue() {
+  // capacity is rounded up to a power of two, full queue rejects pushes
+  Eden::MPMCQueue<std::string> small{5};
+  assert(small.capacity() == 8);
+  for (std::size_t i = 0; i < small.capacity(); ++i) {
+    assert(small.try_push(std::to_string(i)));
+  }
+  assert(!small.try_push(std::string{"overflow"}));
+  std::string front{};
+  assert(small.try_pop(front) && front == "0");
+
+  // a throwing copy claims no cell => the queue keeps working
+  Eden::MPMCQueue<ThrowingCopy> throwing{4};
+  ThrowingCopy first{1};
+  ThrowingCopy second{2};
+  ThrowingCopy::fail = true;
+  bool thrown = false;
+  try {
+    throwing.try_push(first);
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown && throwing.empty());
+  ThrowingCopy::fail = false;
+  assert(throwing.try_push(second));
+  ThrowingCopy popped{};
+  assert(throwing.try_pop(popped) && popped.value == 2);
+  assert(!throwing.try_pop(popped));
+
+  // concurrent producers and consumers see every element exactly once
+  static constexpr std::size_t PER_THREAD = 10000;
+  Eden::MPMCQueue<std::size_t> queue{64};
+  std::atomic<std::size_t> sum{0};
+  std::vector<std::thread> threads{};
+  for (std::size_t p = 0; p < 2; ++p) {
+    threads.emplace_back([&] {
+      for (std::size_t i = 1; i <= PER_THREAD; ++i) {
+        queue.push(i);
+      }
+    });
+  }
+  for (std::size_t c = 0; c < 2; ++c) {
+    threads.emplace_back([&] {
+      std::size_t value{};
+      for (std::size_t popped = 0; popped < PER_THREAD;) {
+        if (queue.try_pop(value)) {
+          sum += value;
+          ++popped;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &&thread : threads) {
+    thread.join();
+  }
+  assert(sum == 2 * PER_THREAD * (PER_THREAD + 1) / 2);
+  assert(queue.empty());
+
+  Eden::println("`test_mpmc_queue()` passed!");
+  Eden::println();
+}
+
+}  // namespace Test
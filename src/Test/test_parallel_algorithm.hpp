@@ -0,0 +1,63 @@
+/**
+ * @file test_parallel_algorithm.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <vector>
+
+#include "../ParallelAlgorithm.hpp"
+#include "../Print.hpp"
+
+namespace Test {
+
+void test_parallel_algorithm() {
+  static constexpr std::size_t LEN = 100000;
+  // 4 workers even on a single core (an elastic pool isn't clamped to
+  // `hardware_concurrency()`), so that the chunked paths always run
+  Eden::ThreadPool pool{Eden::ThreadPoolOptions{
+      .numThreads = 4, .elastic = true, .minThreads = 4, .maxThreads = 4}};
+  assert(pool.threads_num() == 4);
+
+  for (auto schedule :
+       {Eden::ChunkSchedule::static_partition, Eden::ChunkSchedule::guided,
+        Eden::ChunkSchedule::adaptive}) {
+    Eden::ParallelOptions options{
+        .schedule = schedule, .grainSize = 256, .inlineThreshold = 64};
+
+    std::vector<std::size_t> seq(LEN);
+    Eden::parallel_for(
+        pool, std::size_t{0}, LEN, [&](std::size_t i) { seq[i] = i; },
+        options);
+
+    std::vector<std::size_t> doubled(LEN);
+    Eden::parallel_transform(
+        pool, seq.begin(), seq.end(), doubled.begin(),
+        [](std::size_t x) { return 2 * x; }, options);
+
+    auto sum = Eden::parallel_reduce(pool, doubled.begin(), doubled.end(),
+                                     std::size_t{0}, std::plus<>{}, options);
+    assert(sum == LEN * (LEN - 1));
+
+    std::vector<std::size_t> prefix(LEN);
+    Eden::parallel_scan(pool, seq.begin(), seq.end(), prefix.begin(),
+                        std::plus<>{}, options);
+    for (std::size_t i = 0; i < LEN; ++i) {
+      assert(prefix[i] == i * (i + 1) / 2);
+    }
+  }
+
+  Eden::println("`test_parallel_algorithm()` passed!");
+  Eden::println();
+}
+
+}  // namespace Test
@@ -0,0 +1,99 @@
+/**
+ * @file test_strand.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-15
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Print.hpp"
+#include "../Strand.hpp"
+
+namespace Test {
+
+void test_strand() {
+  Eden::ThreadPool pool{4};
+
+  // several producers: one task at a time, each producer's tasks in order
+  constexpr int producer_num = 4;
+  constexpr int task_num = 2000;
+  Eden::Strand strand{pool};
+  std::atomic<int> inside{0};
+  std::vector<int> last(producer_num, -1);  // only touched by the strand
+  bool ordered = true;
+  std::vector<std::thread> producers{};
+  for (int p = 0; p < producer_num; ++p) {
+    producers.emplace_back([&, p] {
+      for (int i = 0; i < task_num; ++i) {
+        strand.post([&, p, i] {
+          assert(++inside == 1);
+          assert(strand.running_in_this_thread());
+          ordered = ordered && last[p] == i - 1;
+          last[p] = i;
+          --inside;
+        });
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  // queued after everything above => sees all of it
+  auto total = strand.submit([&last] {
+    int sum = 0;
+    for (auto value : last) {
+      sum += value + 1;
+    }
+    return sum;
+  });
+  assert(total.get() == producer_num * task_num);
+  assert(ordered);
+  assert(!strand.running_in_this_thread());
+
+  // per-key order, without a mutex around the per-key state
+  Eden::KeyedStrands<std::string> sessions{pool};
+  std::vector<std::string> keys{"alice", "bob", "carol"};
+  std::vector<std::vector<int>> logs(keys.size());
+  for (int i = 0; i < 100; ++i) {
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+      sessions.post(keys[k], [&logs, k, i] { logs[k].push_back(i); });
+    }
+  }
+  for (std::size_t k = 0; k < keys.size(); ++k) {
+    sessions.submit(keys[k], [] {}).get();
+    assert(logs[k].size() == 100);
+    for (int i = 0; i < 100; ++i) {
+      assert(logs[k][static_cast<std::size_t>(i)] == i);
+    }
+  }
+
+  // a strand of a stopped pool rejects every post (none is left queued
+  // behind a drain which would never run)
+  Eden::ThreadPool stopped{1};
+  Eden::Strand orphan{stopped};
+  stopped.shutdown();
+  for (int i = 0; i < 2; ++i) {
+    try {
+      orphan.post([] {});
+      assert(false);
+    } catch (const std::runtime_error &) {
+    }
+  }
+
+  Eden::println("`test_strand()` passed!");
+  Eden::println();
+}
+
+}  // namespace Test
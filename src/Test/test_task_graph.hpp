@@ -0,0 +1,130 @@
+/**
+ * @file test_task_graph.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+
+#include "../Print.hpp"
+#include "../TaskGraph.hpp"
+
+namespace Test {
+
+void test_task_graph() {
+  // a single worker: a stage blocking on its predecessors would deadlock
+  Eden::ThreadPool pool{1};
+
+  // diamond: a -> (b, c) -> d, where d sees the work of both branches
+  Eden::TaskGraph graph{};
+  std::atomic<int> value{0};
+  int seen = 0;
+  auto a = graph.emplace([&value] { value = 1; });
+  auto b = graph.emplace([&value] { value += 10; });
+  auto c = graph.emplace([&value] { value += 100; });
+  auto d = graph.emplace([&value, &seen] { seen = value; });
+  a.precede(b, c);
+  d.succeed(b, c);
+  for (int run = 0; run < 10; ++run) {
+    graph.run(pool).get();
+    assert(seen == 111);
+  }
+
+  // the same subgraph, composed twice, then reused as a graph of its own
+  Eden::TaskGraph sub{};
+  std::atomic<int> subRuns{0};
+  auto first = sub.emplace([&subRuns] { ++subRuns; });
+  auto second = sub.emplace([&subRuns] { ++subRuns; });
+  first.precede(second);
+  Eden::TaskGraph outer{};
+  int order = 0;
+  auto before = outer.emplace([&order] { order = 1; });
+  auto left = outer.compose(sub);
+  auto right = outer.compose(sub);
+  auto after = outer.emplace([&order, &subRuns] {
+    assert(order == 1 && subRuns == 4);
+    order = 2;
+  });
+  before.precede(left, right);
+  after.succeed(left, right);
+  outer.run(pool).get();
+  assert(order == 2);
+  sub.run(pool).get();
+  assert(subRuns == 6);
+
+  // the first exception reaches the caller, the rest of the run is skipped
+  Eden::TaskGraph failing{};
+  bool skipped = true;
+  auto thrower = failing.emplace([] { throw std::runtime_error{"stage"}; });
+  auto later = failing.emplace([&skipped] { skipped = false; });
+  thrower.precede(later);
+  try {
+    failing.run(pool).get();
+    assert(false);
+  } catch (const std::runtime_error &) {
+  }
+  assert(skipped);
+
+  // a pool refusing the nodes fails the run, which still completes: the
+  // refused nodes and those after them are skipped (here a stopped pool)
+  Eden::ThreadPool stopped{1};
+  stopped.shutdown();
+  bool ran = false;
+  Eden::TaskGraph refused{};
+  auto head = refused.emplace([&ran] { ran = true; });
+  auto tail = refused.compose(sub);
+  head.precede(tail, refused.emplace([&ran] { ran = true; }));
+  for (int run = 0; run < 2; ++run) {
+    auto done = refused.run(stopped);
+    try {
+      done.get();
+      assert(false);
+    } catch (const std::runtime_error &) {
+    }
+  }
+  assert(!ran && subRuns == 6);
+
+  // (and a bounded queue rejecting the successors a node made ready)
+  Eden::ThreadPool bounded{Eden::ThreadPoolOptions{
+      .numThreads = 1,
+      .maxQueuedTasks = 1,
+      .overflow = Eden::OverflowPolicy::reject}};
+  Eden::TaskGraph fanOut{};
+  std::atomic<int> fanned{0};
+  auto root = fanOut.emplace([&fanned] { ++fanned; });
+  for (int i = 0; i < 4; ++i) {
+    root.precede(fanOut.emplace([&fanned] { ++fanned; }));
+  }
+  try {
+    fanOut.run(bounded).get();
+    assert(false);
+  } catch (const std::runtime_error &) {
+  }
+  assert(fanned >= 1 && fanned < 5);
+
+  // cycles are rejected before anything runs
+  Eden::TaskGraph cyclic{};
+  auto x = cyclic.emplace([] {});
+  auto y = cyclic.emplace([] {});
+  x.precede(y);
+  y.precede(x);
+  try {
+    cyclic.run(pool);
+    assert(false);
+  } catch (const std::logic_error &) {
+  }
+
+  Eden::println("`test_task_graph()` passed!");
+  Eden::println();
+}
+
+}  // namespace Test
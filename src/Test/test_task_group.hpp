@@ -0,0 +1,100 @@
+/**
+ * @file test_task_group.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+
+#include "../Print.hpp"
+#include "../TaskGroup.hpp"
+
+namespace Test {
+
+/// @brief recursive split, each level waiting for its half on a worker
+static long task_group_fib(Eden::ThreadPool &pool, int n) {
+  if (n < 2) {
+    return n;
+  }
+  long left = 0;
+  Eden::TaskGroup group{pool};
+  group.spawn([&pool, &left, n] { left = task_group_fib(pool, n - 1); });
+  auto right = task_group_fib(pool, n - 2);
+  group.wait();
+  return left + right;
+}
+
+void test_task_group() {
+  // two workers, far more nested waits than workers => would deadlock if
+  // `wait()` parked the worker
+  for (bool workStealing : {false, true}) {
+    Eden::ThreadPool pool{
+        Eden::ThreadPoolOptions{.numThreads = 2, .workStealing = workStealing}};
+    auto fib = pool.submit([&pool] { return task_group_fib(pool, 18); });
+    assert(fib.get() == 2584);
+  }
+
+  Eden::ThreadPool pool{2};
+
+  // the first exception reaches `wait()`, once
+  Eden::TaskGroup failing{pool};
+  failing.spawn([] { throw std::runtime_error{"task"}; });
+  try {
+    failing.wait();
+    assert(false);
+  } catch (const std::runtime_error &) {
+  }
+  assert(failing.cancelled());
+  failing.wait();
+
+  // cancel: running tasks see their token, queued ones are skipped
+  // (every worker busy => the last task stays queued)
+  Eden::TaskGroup group{pool};
+  std::atomic<std::size_t> started{0};
+  for (std::size_t i = 0; i < pool.threads_num(); ++i) {
+    group.spawn([&started](std::stop_token token) {
+      ++started;
+      while (!token.stop_requested()) {
+        std::this_thread::yield();
+      }
+    });
+  }
+  while (started < pool.threads_num()) {
+    std::this_thread::yield();
+  }
+  std::atomic<bool> skippedRan{false};
+  group.spawn([&skippedRan] { skippedRan = true; });
+  group.cancel();
+  group.wait();
+  assert(!skippedRan);
+
+  // drain barrier: every task (and its subtasks) done, pool still usable
+  std::atomic<int> done{0};
+  for (int i = 0; i < 100; ++i) {
+    pool.submit_detached([&pool, &done] {
+      pool.submit_detached([&done] { ++done; });
+      ++done;
+    });
+  }
+  pool.wait_idle();
+  assert(done == 200);
+  pool.wait_idle();
+  assert(pool.submit([] { return 1; }).get() == 1);
+
+  Eden::println("`test_task_group()` passed!");
+  Eden::println();
+}
+
+}  // namespace Test
@@ -0,0 +1,844 @@
+/**
+ * @file test_thread_pool.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-02-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "../Print.hpp"
+#include "../ThreadPool.hpp"
+
+namespace Test {
+
+void test_work_stealing() {
+  Eden::ThreadPool pool{Eden::ThreadPoolOptions{.workStealing = true}};
+
+  // tasks submitted from inside a worker land on its own deque
+  auto outer = pool.enqueue([&pool] {
+    std::vector<std::future<std::size_t>> inner{};
+    for (std::size_t i = 0; i < 100; ++i) {
+      inner.emplace_back(pool.enqueue([i] { return i; }));
+    }
+    return inner;
+  });
+  std::size_t sum = 0;
+  for (auto &&res : outer.get()) {
+    sum += res.get();
+  }
+  assert(sum == 4950);
+
+  Eden::println("`test_work_stealing()` passed!");
+  Eden::println();
+}
+
+void test_lock_free_queue() {
+  // a tiny capacity forces producers through the `queue is full` path
+  Eden::ThreadPool pool{Eden::ThreadPoolOptions{
+      .queueKind = Eden::TaskQueueKind::lock_free, .queueCapacity = 4}};
+
+  std::vector<std::future<std::size_t>> results{};
+  for (std::size_t i = 0; i < 1000; ++i) {
+    results.emplace_back(pool.enqueue([i] { return i; }));
+  }
+  std::size_t sum = 0;
+  for (auto &&res : results) {
+    sum += res.get();
+  }
+  assert(sum == 499500);
+
+  Eden::println("`test_lock_free_queue()` passed!");
+  Eden::println();
+}
+
+void test_submit() {
+  Eden::ThreadPool pool{};
+
+  std::size_t sum = 0;
+  for (std::size_t i = 0; i < 100; ++i) {
+    sum += pool.submit([i] { return i; }).get();
+  }
+  assert(sum == 4950);
+
+  // exceptions travel through `Eden::Future` just like `std::future`
+  auto failed = pool.submit([]() -> int { throw std::runtime_error{"boom"}; });
+  try {
+    failed.get();
+    assert(false);
+  } catch (const std::runtime_error &err) {
+    assert(std::string_view{err.what()} == "boom");
+  }
+
+  std::atomic<std::size_t> counter{0};
+  for (std::size_t i = 0; i < 100; ++i) {
+    pool.submit_detached([&counter] { ++counter; });
+  }
+  pool.submit([] {}).get();
+  while (counter != 100) {
+    std::this_thread::yield();
+  }
+
+  // a small task (and its promise) fits in the `UniqueTask` and the state
+  // is recycled => no allocation at all once warm, whichever thread drops
+  // the last reference to the state (with the lock-free queue, whose ring
+  // is allocated up front)
+  Eden::ThreadPool quiet{Eden::ThreadPoolOptions{
+      .numThreads = 1, .queueKind = Eden::TaskQueueKind::lock_free}};
+  auto round_trips = [&quiet, &counter] {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < 1000; ++i) {
+      sum += quiet.submit([i] { return i; }).get();
+      quiet.submit_detached([&counter] { ++counter; });
+      // dropped before it runs => the worker frees this state
+      (void)quiet.submit([i] { return i; });
+    }
+    quiet.wait_idle();
+    return sum;
+  };
+  round_trips();
+  auto states = Eden::detail::StatePool::heap_allocations();
+  auto tasks = Eden::UniqueTask::heap_allocations();
+  assert(round_trips() == 499500);
+  assert(Eden::detail::StatePool::heap_allocations() == states);
+  assert(Eden::UniqueTask::heap_allocations() == tasks);
+
+  // a big one is put on the heap
+  struct Big {
+    char bytes[Eden::UniqueTask::inline_size + 1]{};
+  };
+  quiet.submit([big = Big{}] { return big.bytes[0]; }).get();
+  assert(Eden::UniqueTask::heap_allocations() == tasks + 1);
+
+  Eden::println("`test_submit()` passed!");
+  Eden::println();
+}
+
+void test_enqueue_bulk() {
+  Eden::ThreadPool pool{};
+
+  std::vector<std::function<std::size_t()>> batch{};
+  for (std::size_t i = 0; i < 100; ++i) {
+    batch.emplace_back([i] { return i; });
+  }
+  std::size_t sum = 0;
+  for (auto &&res : pool.enqueue_bulk(batch)) {
+    sum += res.get();
+  }
+  for (auto &&res : pool.enqueue_n(100, [](std::size_t i) {
+         return [i] { return i; };
+       })) {
+    sum += res.get();
+  }
+  assert(sum == 2 * 4950);
+
+  Eden::println("`test_enqueue_bulk()` passed!");
+  Eden::println();
+}
+
+void test_continuation() {
+  // a single worker: any stage blocking it would deadlock the whole chain
+  Eden::ThreadPool pool{1};
+
+  auto chained = pool.submit([] { return 20; })
+                     .then([](int x) { return x + 1; })
+                     .then([](int x) { return 2 * x; });
+  assert(chained.get() == 42);
+
+  // an exception skips value continuations, but reaches future ones
+  auto recovered =
+      pool.submit([]() -> int { throw std::runtime_error{"boom"}; })
+          .then([](int x) { return x + 1; })
+          .then([](Eden::Future<int> failed) {
+            try {
+              return failed.get();
+            } catch (const std::runtime_error &) {
+              return -1;
+            }
+          });
+  assert(recovered.get() == -1);
+
+  auto all = Eden::when_all(pool.submit([] { return 1; }),
+                            pool.submit([] { return std::size_t{2}; }))
+                 .then([](std::tuple<Eden::Future<int>, Eden::Future<std::size_t>>
+                              results) {
+                   return std::get<0>(results).get() +
+                          static_cast<int>(std::get<1>(results).get());
+                 });
+  assert(all.get() == 3);
+
+  std::vector<Eden::Future<std::size_t>> inputs{};
+  for (std::size_t i = 0; i < 100; ++i) {
+    inputs.emplace_back(pool.submit([i] { return i; }));
+  }
+  auto sum = Eden::when_all(std::move(inputs))
+                 .then([](std::vector<Eden::Future<std::size_t>> results) {
+                   std::size_t sum = 0;
+                   for (auto &res : results) {
+                     sum += res.get();
+                   }
+                   return sum;
+                 });
+  assert(sum.get() == 4950);
+
+  Eden::Promise<int> never{};
+  auto first = Eden::when_any(never.get_future(), pool.submit([] { return 7; }))
+                   .get();
+  assert(first.index == 1);
+  assert(std::get<1>(first.futures).get() == 7);
+
+  // a continuation falling due on a shut down pool is refused
+  Eden::ThreadPool stopped{1};
+  Eden::Promise<int> late{};
+  auto refused = late.get_future().via(stopped.executor()).then([](int x) {
+    return x + 1;
+  });
+  stopped.shutdown();
+  late.set_value(1);
+  try {
+    refused.get();
+    assert(false);
+  } catch (const std::future_error &error) {
+    assert(error.code() == std::future_errc::broken_promise);
+  }
+
+  Eden::println("`test_continuation()` passed!");
+  Eden::println();
+}
+
+void test_worker_placement() {
+  assert((Eden::CpuTopology::parse_cpu_list("0-3,8,10-11") ==
+          std::vector<std::size_t>{0, 1, 2, 3, 8, 10, 11}));
+
+  auto allowed = Eden::CpuTopology::allowed_cpus();
+  assert(!allowed.empty() && std::is_sorted(allowed.begin(), allowed.end()));
+#if defined(__linux__)
+  // sparse node ids (node1 is missing), CPUs outside the affinity mask
+  // dropped, and so is a node left without any
+  auto root = std::filesystem::temp_directory_path() /
+              ("eden_topology_" +
+               std::to_string(
+                   std::chrono::steady_clock::now().time_since_epoch().count()));
+  auto write = [&root](const std::string &file, const std::string &line) {
+    std::filesystem::create_directories((root / file).parent_path());
+    std::ofstream{root / file} << line << "\n";
+  };
+  write("online", "0,2,5");
+  write("node0/cpulist", std::to_string(allowed.front()));
+  write("node2/cpulist", "0-" + std::to_string(allowed.back()) + ",100000");
+  write("node5/cpulist", "100000");
+  auto sparse = Eden::CpuTopology::detect(root.string());
+  std::filesystem::remove_all(root);
+  assert(sparse.nodes.size() == 2);
+  assert(sparse.nodes[0] == std::vector<std::size_t>{allowed.front()});
+  assert(sparse.nodes[1] == allowed);
+  // (no sysfs there => one node of every allowed CPU)
+  auto fallback = Eden::CpuTopology::detect(root.string());
+  assert(fallback.nodes.size() == 1 && fallback.nodes[0] == allowed);
+#endif
+
+  // pinned (to the allowed CPUs, not to CPU 0 .. n - 1)
+  Eden::ThreadPool pinned{
+      Eden::ThreadPoolOptions{.placement = Eden::WorkerPlacement::pinned}};
+  assert(pinned.submit([] { return 1; }).get() == 1);
+#if defined(__linux__)
+  auto ranOn = pinned.submit([] { return Eden::CpuTopology::allowed_cpus(); });
+  auto pinnedTo = ranOn.get();
+  assert(pinnedTo.size() == 1 &&
+         std::binary_search(allowed.begin(), allowed.end(), pinnedTo[0]));
+#endif
+
+  Eden::ThreadPool numa{
+      Eden::ThreadPoolOptions{.placement = Eden::WorkerPlacement::numa_spread}};
+  std::vector<Eden::Future<std::size_t>> results{};
+  for (std::size_t i = 0; i < 100; ++i) {
+    results.emplace_back(numa.submit_on(i % numa.numa_nodes_num(),
+                                        [i] { return i; }));
+  }
+  std::size_t sum = 0;
+  for (auto &res : results) {
+    sum += res.get();
+  }
+  assert(sum == 4950);
+  assert(numa.enqueue_on(0, [] { return 2; }).get() == 2);
+
+  Eden::println("`test_worker_placement()` passed!");
+  Eden::println();
+}
+
+void test_idle_policy() {
+  for (auto idle : {Eden::IdlePolicy::low_latency(),
+                    Eden::IdlePolicy::power_saving(),
+                    Eden::IdlePolicy{.spins = 16, .yields = 16}}) {
+    for (bool workStealing : {false, true}) {
+      Eden::ThreadPool pool{Eden::ThreadPoolOptions{
+          .workStealing = workStealing, .idle = idle}};
+      std::size_t sum = 0;
+      for (std::size_t i = 0; i < 100; ++i) {
+        sum += pool.submit([i] { return i; }).get();
+      }
+      assert(sum == 4950);
+    }
+  }
+
+  Eden::println("`test_idle_policy()` passed!");
+  Eden::println();
+}
+
+void test_elastic() {
+  using namespace std::chrono_literals;
+
+  for (auto queueKind :
+       {Eden::TaskQueueKind::locked, Eden::TaskQueueKind::lock_free}) {
+    Eden::ThreadPool pool{Eden::ThreadPoolOptions{
+        .numThreads = 1,
+        .queueKind = queueKind,
+        .elastic = true,
+        .minThreads = 1,
+        .maxThreads = 4,
+        .growQueueDepth = 1,
+        .idleTimeout = 20ms}};
+    assert(pool.threads_num() == 1);
+
+    // blocked tasks back the queue up => the pool grows to `maxThreads`
+    std::atomic<bool> release{false};
+    std::vector<Eden::Future<void>> blocked{};
+    auto block_until_grown = [&] {
+      release = false;
+      while (pool.threads_num() < 4 && blocked.size() < 64) {
+        blocked.emplace_back(pool.submit([&release] {
+          while (!release) {
+            std::this_thread::sleep_for(1ms);
+          }
+        }));
+      }
+      assert(pool.threads_num() == 4);
+      release = true;
+      for (auto &res : blocked) {
+        res.get();
+      }
+      blocked.clear();
+    };
+    block_until_grown();
+
+    // idle workers retire down to `minThreads`
+    while (pool.threads_num() > 1) {
+      std::this_thread::sleep_for(5ms);
+    }
+    // ... and retired slots are reused when the load comes back
+    block_until_grown();
+
+    // producers racing with `grow()` (a data race there shows under TSAN)
+    std::atomic<std::size_t> ran{0};
+    std::vector<std::thread> producers{};
+    for (int p = 0; p < 3; ++p) {
+      producers.emplace_back([&pool, &ran] {
+        for (int i = 0; i < 200; ++i) {
+          pool.submit_detached([&ran] { ++ran; });
+        }
+      });
+    }
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    pool.wait_idle();
+    assert(ran == 600);
+  }
+
+  Eden::println("`test_elastic()` passed!");
+  Eden::println();
+}
+
+void test_metrics() {
+  Eden::ThreadPool pool{Eden::ThreadPoolOptions{.collectTimings = true}};
+  auto before = pool.metrics();
+  assert(before.tasks_executed() == 0);
+  assert(pool.remaining_tasks_num() == 0);
+
+  std::atomic<bool> release{false};
+  auto blocked = pool.submit([&release] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  while (pool.running_tasks_num() != pool.threads_num()) {
+    // keep every worker busy so the next tasks stay queued
+    if (pool.running_tasks_num() + pool.remaining_tasks_num() <
+        pool.threads_num()) {
+      pool.submit_detached([&release] {
+        while (!release) {
+          std::this_thread::yield();
+        }
+      });
+    }
+    std::this_thread::yield();
+  }
+  assert(pool.unused_threads_num() == 0);
+  auto queued = pool.submit([] {});
+  assert(pool.remaining_tasks_num() == 1);
+  release = true;
+  blocked.get();
+  queued.get();
+
+  std::vector<Eden::Future<void>> results{};
+  for (std::size_t i = 0; i < 100; ++i) {
+    results.emplace_back(pool.submit([] {}));
+  }
+  for (auto &res : results) {
+    res.get();
+  }
+  auto after = pool.metrics();
+  assert(after.tasks_executed() >= 102);
+  assert(after.queue_wait_percentile(1) >= after.queue_wait_percentile(0.5));
+  assert(after.queue_wait_percentile(1).count() > 0);
+  assert(after.throughput_since(before) > 0);
+  assert(!after.to_string().empty());
+
+  Eden::println("`test_metrics()` passed!");
+  Eden::println();
+}
+
+void test_priority() {
+  using Eden::TaskPriority;
+
+  for (bool workStealing : {false, true}) {
+    // one worker, blocked while the queue fills up
+    Eden::ThreadPool pool{Eden::ThreadPoolOptions{
+        .numThreads = 1, .workStealing = workStealing, .priorityAging = 0}};
+    std::atomic<bool> release{false};
+    auto blocked = pool.submit([&release] {
+      while (!release) {
+        std::this_thread::yield();
+      }
+    });
+    while (pool.running_tasks_num() == 0) {
+      std::this_thread::yield();
+    }
+    std::vector<int> order{};
+    std::vector<Eden::Future<void>> results{};
+    results.emplace_back(
+        pool.submit(TaskPriority::low, [&order] { order.push_back(3); }));
+    results.emplace_back(pool.submit([&order] { order.push_back(2); }));
+    results.emplace_back(
+        pool.submit(TaskPriority::high, [&order] { order.push_back(1); }));
+    release = true;
+    blocked.get();
+    for (auto &res : results) {
+      res.get();
+    }
+    assert((order == std::vector<int>{1, 2, 3}));
+  }
+
+  // aging: a low task passed over by 2 more urgent ones runs next
+  Eden::ThreadPool pool{
+      Eden::ThreadPoolOptions{.numThreads = 1, .priorityAging = 2}};
+  std::atomic<bool> release{false};
+  auto blocked = pool.enqueue(TaskPriority::high, [&release] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  while (pool.running_tasks_num() == 0) {
+    std::this_thread::yield();
+  }
+  std::vector<int> order{};
+  std::vector<std::future<void>> results{};
+  results.emplace_back(
+      pool.enqueue(TaskPriority::low, [&order] { order.push_back(0); }));
+  for (int i = 1; i <= 4; ++i) {
+    results.emplace_back(
+        pool.enqueue(TaskPriority::high, [&order, i] { order.push_back(i); }));
+  }
+  release = true;
+  blocked.get();
+  for (auto &res : results) {
+    res.get();
+  }
+  assert((order == std::vector<int>{1, 2, 0, 3, 4}));
+
+  Eden::println("`test_priority()` passed!");
+  Eden::println();
+}
+
+void test_timers() {
+  using namespace std::chrono_literals;
+  using Clock = std::chrono::steady_clock;
+
+  // the wheel alone, on a fake clock (crossing every cascade boundary)
+  auto start = Clock::now();
+  Eden::TimerWheel wheel{1ms, start};
+  std::vector<int> order{};
+  for (int delay : {70000, 3, 300, 1, 256}) {
+    wheel.schedule(start + std::chrono::milliseconds{delay},
+                   [&order, delay] { order.push_back(delay); });
+  }
+  std::vector<Eden::UniqueTask> fired{};
+  wheel.advance(start + 299ms, fired);
+  assert(fired.size() == 3);
+  wheel.advance(start + 69999ms, fired);
+  assert(fired.size() == 4 && wheel.size() == 1);
+  wheel.advance(start + 70000ms, fired);
+  assert(wheel.empty() && !wheel.next_wake());
+  for (auto &action : fired) {
+    action();
+  }
+  assert((order == std::vector<int>{1, 3, 256, 300, 70000}));
+
+  // delayed tasks: never early, in due order
+  Eden::ThreadPool pool{2};
+  auto enqueued = Clock::now();
+  auto late = pool.enqueue_after(30ms, [] { return Clock::now(); });
+  auto soon = pool.enqueue_at(enqueued + 10ms, [] { return Clock::now(); });
+  auto soonAt = soon.get();
+  assert(soonAt - enqueued >= 10ms);
+  assert(late.get() - enqueued >= 30ms);
+
+  // periodic task, until cancelled
+  std::atomic<int> runs{0};
+  auto handle = pool.enqueue_every(2ms, [&runs] { ++runs; });
+  while (runs < 5) {
+    std::this_thread::yield();
+  }
+  handle.cancel();
+  std::this_thread::sleep_for(20ms);
+  auto stopped = runs.load();
+  std::this_thread::sleep_for(20ms);
+  assert(runs == stopped);
+
+  // pending timers are dropped with the pool
+  std::future<void> dropped{};
+  {
+    Eden::ThreadPool shortLived{1};
+    dropped = shortLived.enqueue_after(1h, [] {});
+  }
+  try {
+    dropped.get();
+    assert(false);
+  } catch (const std::future_error &error) {
+    assert(error.code() == std::future_errc::broken_promise);
+  }
+
+  Eden::println("`test_timers()` passed!");
+  Eden::println();
+}
+
+void test_backpressure() {
+  using Eden::OverflowPolicy;
+  using namespace std::chrono_literals;
+
+  // one worker held by a task, so that the queue (2 slots) fills up
+  struct Held {
+    explicit Held(Eden::ThreadPoolOptions options) : pool(options) {
+      blocker = pool.enqueue([this] {
+        while (!release) {
+          std::this_thread::yield();
+        }
+      });
+      while (pool.running_tasks_num() == 0) {
+        std::this_thread::yield();
+      }
+    }
+    void finish() {
+      release = true;
+      blocker.get();
+    }
+    Eden::ThreadPool pool;
+    std::atomic<bool> release{false};
+    std::future<void> blocker{};
+  };
+  auto options = [](OverflowPolicy overflow, bool workStealing) {
+    return Eden::ThreadPoolOptions{.numThreads = 1,
+                                   .workStealing = workStealing,
+                                   .maxQueuedTasks = 2,
+                                   .overflow = overflow};
+  };
+
+  for (bool workStealing : {false, true}) {
+    // reject (and `try_enqueue()` whatever the policy)
+    Held rejecting{options(OverflowPolicy::reject, workStealing)};
+    auto a = rejecting.pool.enqueue([] { return 1; });
+    auto b = rejecting.pool.try_enqueue([] { return 2; });
+    assert(b.has_value());
+    assert(!rejecting.pool.try_enqueue([] { return 3; }).has_value());
+    try {
+      rejecting.pool.enqueue([] { return 3; });
+      assert(false);
+    } catch (const std::runtime_error &) {
+    }
+    rejecting.finish();
+    assert(a.get() + b->get() == 3);
+
+    // drop_oldest: the first queued task gives way
+    Held dropping{options(OverflowPolicy::drop_oldest, workStealing)};
+    auto first = dropping.pool.enqueue([] { return 1; });
+    auto second = dropping.pool.enqueue([] { return 2; });
+    auto third = dropping.pool.enqueue([] { return 3; });
+    dropping.finish();
+    try {
+      first.get();
+      assert(false);
+    } catch (const std::future_error &error) {
+      assert(error.code() == std::future_errc::broken_promise);
+    }
+    assert(second.get() + third.get() == 5);
+  }
+
+  // caller_runs: the overflowing task runs on the submitting thread
+  Held running{options(OverflowPolicy::caller_runs, false)};
+  auto caller = std::this_thread::get_id();
+  running.pool.enqueue([] {});
+  running.pool.enqueue([] {});
+  auto ranOn = running.pool.enqueue([] { return std::this_thread::get_id(); });
+  assert(ranOn.get() == caller);
+  running.finish();
+
+  // block: the producer waits until a worker frees a slot
+  Held blocking{options(OverflowPolicy::block, false)};
+  blocking.pool.enqueue([] {});
+  blocking.pool.enqueue([] {});
+  std::atomic<bool> pushed{false};
+  std::thread producer{[&blocking, &pushed] {
+    blocking.pool.enqueue([] {});
+    pushed = true;
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  assert(!pushed);
+  blocking.finish();
+  producer.join();
+  assert(pushed);
+  blocking.pool.wait_idle();
+
+  // due timers are queued past the bound: the timer thread neither blocks
+  // nor runs them itself
+  for (auto overflow : {OverflowPolicy::block, OverflowPolicy::caller_runs}) {
+    Held full{options(overflow, false)};
+    full.pool.enqueue([] {});
+    full.pool.enqueue([] {});
+    auto workerId = [] { return std::this_thread::get_id(); };
+    auto first = full.pool.enqueue_after(1ms, workerId);
+    auto second = full.pool.enqueue_after(2ms, workerId);
+    auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (full.pool.remaining_tasks_num() < 4 &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    assert(full.pool.remaining_tasks_num() == 4);
+    full.finish();
+    assert(first.get() == second.get());
+  }
+
+  Eden::println("`test_backpressure()` passed!");
+  Eden::println();
+}
+
+void test_trace() {
+  using Eden::TraceKind;
+
+  // the recorder alone: a ring of 8 keeps the last 7 events
+  Eden::TaskTracer tracer{8};
+  std::thread worker{[&tracer] {
+    for (std::uint64_t task = 1; task <= 10; ++task) {
+      tracer.record(TraceKind::start, task, 0);
+      tracer.record(TraceKind::finish, task, 0);
+    }
+  }};
+  worker.join();
+  tracer.record(TraceKind::enqueue, tracer.next_task_id(), -1);
+  std::ostringstream oss{};
+  tracer.dump(oss);
+  auto trace = oss.str();
+  auto count = [&trace](std::string_view pattern) {
+    std::size_t found = 0;
+    for (auto at = trace.find(pattern); at != std::string::npos;
+         at = trace.find(pattern, at + 1)) {
+      ++found;
+    }
+    return found;
+  };
+  assert(count(R"("ph":"B")") == 3 && count(R"("ph":"E")") == 4);
+  assert(count(R"("ph":"i")") == 1);
+  assert(count(R"("name":"worker 0")") == 1);
+  assert(count(R"("task":8})") == 1 && count(R"("task":7})") == 0);
+
+  // a thread alternating between tracers keeps one track in each
+  Eden::TaskTracer first{16};
+  Eden::TaskTracer second{16};
+  std::thread alternating{[&first, &second] {
+    for (std::uint64_t task = 1; task <= 100; ++task) {
+      first.record(TraceKind::enqueue, task, -1);
+      second.record(TraceKind::enqueue, task, -1);
+    }
+  }};
+  alternating.join();
+  for (const auto *alternated : {&first, &second}) {
+    std::ostringstream dumped{};
+    alternated->dump(dumped);
+    trace = dumped.str();
+    assert(count(R"("name":"thread_name")") == 1);
+  }
+
+  // two pools fed in turns by this thread: one track per thread and pool
+  // (without `EDEN_THREAD_POOL_TRACE`, a pool writes an empty trace)
+  Eden::ThreadPool pools[2]{Eden::ThreadPool{2}, Eden::ThreadPool{2}};
+  for (int i = 0; i < 50; ++i) {
+    for (auto &pool : pools) {
+      pool.submit([] {}).get();
+    }
+  }
+  for (auto &pool : pools) {
+    std::ostringstream dumped{};
+    pool.dump_trace(dumped);
+    trace = dumped.str();
+    if (EDEN_THREAD_POOL_TRACE) {
+      assert(count(R"("name":"thread_name")") <= 3);
+      assert(count(R"("name":"enqueue")") == 50);
+      assert(count(R"("cat":"task","name":"task","pid")") == 50);
+    } else {
+      assert(trace.find(R"("traceEvents":[])") != std::string::npos);
+    }
+  }
+
+  Eden::println("`test_trace()` passed!");
+  Eden::println();
+}
+
+void test_shutdown() {
+  using Eden::ShutdownMode;
+
+  // one worker held by a task while 4 more are queued; the holder is let go
+  // once `shutdown()` took the queue (or a bit later when draining)
+  auto held = [](Eden::ThreadPool &pool, std::atomic<bool> &release) {
+    pool.submit_detached([&release] {
+      while (!release) {
+        std::this_thread::yield();
+      }
+    });
+    while (pool.running_tasks_num() == 0) {
+      std::this_thread::yield();
+    }
+    std::vector<std::future<int>> queued{};
+    for (int i = 1; i <= 4; ++i) {
+      queued.emplace_back(pool.enqueue([i] { return i; }));
+    }
+    return queued;
+  };
+  auto releaser = [](Eden::ThreadPool &pool, std::atomic<bool> &release) {
+    return std::thread{[&pool, &release] {
+      while (pool.remaining_tasks_num() != 0) {
+        std::this_thread::yield();
+      }
+      release = true;
+    }};
+  };
+
+  for (bool workStealing : {false, true}) {
+    auto options = Eden::ThreadPoolOptions{.numThreads = 1,
+                                           .workStealing = workStealing};
+
+    // discard: the queued tasks never run, their futures are broken
+    {
+      Eden::ThreadPool pool{options};
+      std::atomic<bool> release{false};
+      auto queued = held(pool, release);
+      auto unblock = releaser(pool, release);
+      pool.shutdown(ShutdownMode::discard);
+      unblock.join();
+      for (auto &future : queued) {
+        try {
+          future.get();
+          assert(false);
+        } catch (const std::future_error &error) {
+          assert(error.code() == std::future_errc::broken_promise);
+        }
+      }
+      // shut down => no more tasks (and shutting down again is a no-op)
+      try {
+        pool.enqueue([] {});
+        assert(false);
+      } catch (const std::runtime_error &) {
+      }
+      pool.shutdown();
+    }
+
+    // handoff: the queued tasks run on another pool
+    {
+      Eden::ThreadPool pool{options};
+      std::atomic<bool> release{false};
+      auto queued = held(pool, release);
+      auto unblock = releaser(pool, release);
+      auto pending = pool.shutdown_and_return_pending();
+      unblock.join();
+      assert(pending.size() == 4);
+      Eden::ThreadPool other{1};
+      for (auto &task : pending) {
+        other.submit_detached(std::move(task));
+      }
+      int sum = 0;
+      for (auto &future : queued) {
+        sum += future.get();
+      }
+      assert(sum == 10);
+      assert(pool.shutdown_and_return_pending().empty());
+    }
+
+    // drain: everything queued runs first
+    {
+      Eden::ThreadPool pool{options};
+      std::atomic<bool> release{false};
+      auto queued = held(pool, release);
+      std::thread unblock{[&release] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        release = true;
+      }};
+      pool.shutdown(ShutdownMode::drain);
+      unblock.join();
+      int sum = 0;
+      for (auto &future : queued) {
+        sum += future.get();
+      }
+      assert(sum == 10);
+    }
+  }
+
+  Eden::println("`test_shutdown()` passed!");
+  Eden::println();
+}
+
+void test_thread_pool() {
+  test_work_stealing();
+  test_lock_free_queue();
+  test_submit();
+  test_enqueue_bulk();
+  test_continuation();
+  test_worker_placement();
+  test_idle_policy();
+  test_elastic();
+  test_metrics();
+  test_priority();
+  test_timers();
+  test_backpressure();
+  test_trace();
+  test_shutdown();
+}
+
+}  // namespace Test
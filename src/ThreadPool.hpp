@@ -11,66 +11,1300 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
 #include <future>
 #include <iostream>
-#include <queue>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
+#include "MPMCQueue.hpp"
+#include "ThreadPool/future.hpp"
+#include "ThreadPool/idle_policy.hpp"
+#include "ThreadPool/metrics.hpp"
+#include "ThreadPool/multi_level_queue.hpp"
+#include "ThreadPool/timer_wheel.hpp"
+#include "ThreadPool/trace.hpp"
+#include "ThreadPool/topology.hpp"
+#include "ThreadPool/unique_task.hpp"
+#include "ThreadPool/work_stealing_deque.hpp"
+
 namespace Eden {
 
+/**
+ * @brief structure backing the shared task queue of `ThreadPool`
+ *
+ */
+enum class TaskQueueKind {
+  /// @brief `MultiLevelQueue` protected by a mutex (unbounded)
+  locked,
+  /// @brief `Eden::MPMCQueue` (bounded, producers never take a lock)
+  lock_free,
+};
+
+/**
+ * @brief priority of a task submitted to `ThreadPool`
+ *
+ */
+enum class TaskPriority : std::uint8_t {
+  /// @brief run before any `normal` / `low` task
+  high,
+  /// @brief the priority of `enqueue(task)` / `submit(task)`
+  normal,
+  /// @brief run when nothing more urgent is queued (or once aged)
+  low,
+};
+
+/// @brief number of `TaskPriority` levels
+inline constexpr std::size_t task_priority_num = 3;
+
+/**
+ * @brief where the workers of `ThreadPool` run
+ *
+ */
+enum class WorkerPlacement {
+  /// @brief let the OS place (and migrate) the workers
+  os,
+  /// @brief pin worker `i` to `cpus[i % cpus.size()]` (if empty, to the
+  /// i-th CPU the constructing thread may run on, round-robin)
+  pinned,
+  /// @brief spread the workers round-robin over the NUMA nodes, restrict
+  /// each one to the CPUs of its node and give every node its own queue
+  /// (implies `workStealing`)
+  numa_spread,
+};
+
+/**
+ * @brief what `ThreadPool` does with a task submitted while
+ *        `maxQueuedTasks` tasks are already queued
+ *
+ */
+enum class OverflowPolicy {
+  /// @brief wait for room (a worker submitting runs the task itself
+  /// instead, since blocking it could block the whole pool)
+  block,
+  /// @brief throw `std::runtime_error` (see also `try_enqueue()`)
+  reject,
+  /// @brief run the task right away on the submitting thread
+  caller_runs,
+  /// @brief drop the oldest task of the least urgent priority to make room
+  /// (its future gets `broken_promise`)
+  drop_oldest,
+};
+
+/**
+ * @brief how `ThreadPool::shutdown()` treats the tasks still queued
+ *
+ */
+enum class ShutdownMode {
+  /// @brief run every queued task first (what the destructor does)
+  drain,
+  /// @brief drop them => their futures get `broken_promise`
+  discard,
+};
+
+/**
+ * @brief construction options of `ThreadPool`
+ *
+ */
+struct ThreadPoolOptions {
+  /// @brief number of workers (clamped to `hardware_concurrency()`)
+  std::size_t numThreads = std::thread::hardware_concurrency();
+
+  /// @brief give every worker its own deque and let idle workers steal
+  /// (instead of sharing one locked queue between all of them)
+  bool workStealing = false;
+
+  /// @brief structure backing the shared task queue
+  /// (ignored in work-stealing mode, where every worker owns a deque)
+  TaskQueueKind queueKind = TaskQueueKind::locked;
+
+  /// @brief capacity of the `lock_free` queue (rounded up to a power of two)
+  std::size_t queueCapacity = 1 << 16;
+
+  /// @brief where the workers run
+  WorkerPlacement placement = WorkerPlacement::os;
+
+  /// @brief (`pinned` only) the CPUs to pin the workers to
+  std::vector<std::size_t> cpus{};
+
+  /// @brief how long an idle worker spins / yields before parking
+  IdlePolicy idle = IdlePolicy::low_latency();
+
+  /// @brief start and retire workers with the load, between `minThreads`
+  /// and `maxThreads` (`numThreads` is the initial size)
+  /// (shared queue modes only, not with `workStealing` / `numa_spread`)
+  bool elastic = false;
+
+  /// @brief (elastic only) never retire below this many workers
+  std::size_t minThreads = 1;
+
+  /// @brief (elastic only) never start more than this many workers
+  /// (`0` => `hardware_concurrency()`, not clamped otherwise since extra
+  /// workers usually cover tasks blocked on I/O)
+  std::size_t maxThreads = 0;
+
+  /// @brief (elastic only) start a worker when more than this many queued
+  /// tasks are left over once every idle worker took one
+  std::size_t growQueueDepth = 4;
+
+  /// @brief (elastic only) start a worker when nobody is idle, tasks are
+  /// queued, and no worker took one for this long
+  std::chrono::microseconds growWaitTime = std::chrono::milliseconds{1};
+
+  /// @brief (elastic only) retire a worker idle for this long
+  std::chrono::milliseconds idleTimeout = std::chrono::seconds{5};
+
+  /// @brief a queued task passed over by this many dequeues of more urgent
+  /// ones is served next (`0` => strict priorities, low ones may starve)
+  std::size_t priorityAging = 64;
+
+  /// @brief time every task (busy / idle time, queue-wait latency) for
+  /// `metrics()`, at the cost of two clock reads per task
+  /// (the counters are always collected)
+  bool collectTimings = false;
+
+  /// @brief resolution of `enqueue_after()` / `enqueue_at()` /
+  /// `enqueue_every()` (timers fire at most one tick late, never early)
+  std::chrono::microseconds timerTick = std::chrono::milliseconds{1};
+
+  /// @brief most tasks queued (not started yet) at once, so that memory
+  /// stays bounded under overload (`0` => unbounded)
+  std::size_t maxQueuedTasks = 0;
+
+  /// @brief what to do with a task submitted while the queue is full
+  /// (a delayed or periodic task falling due is queued anyway, past the
+  /// bound: the timer thread never blocks, nor runs user tasks)
+  OverflowPolicy overflow = OverflowPolicy::block;
+
+  /// @brief (`EDEN_THREAD_POOL_TRACE` builds only) trace events kept per
+  /// thread for `dump_trace()` (the latest ones)
+  std::size_t traceEvents = std::size_t{1} << 14;
+};
+
 class ThreadPool {
  private:
+  /// @brief the type stored in the task queues
+  ///        (a `UniqueTask`, plus the time it was queued when timing)
+  struct Task {
+    Task() noexcept = default;
+
+    template <typename F>
+      requires(!std::same_as<std::decay_t<F>, Task> &&
+               std::constructible_from<UniqueTask, F>)
+    Task(F &&func)  // NOLINT(google-explicit-constructor)
+        : func(std::forward<F>(func)) {}
+
+    void operator()() { func(); }
+
+    UniqueTask func{};
+
+    /// @brief (timings only) `now_ticks()` when the task was queued
+    std::int64_t enqueuedAt = 0;
+
+#if EDEN_THREAD_POOL_TRACE
+    /// @brief id of the task in the trace
+    std::uint64_t traceId = 0;
+#endif
+  };
+
   void init_threads(std::size_t numThreads) {
+    if (numThreads == 0) [[unlikely]] {
+      // `hardware_concurrency()` is allowed to return 0
+      numThreads = 1;
+    }
+    place_workers(numThreads);
+    if (workStealing) {
+      localQueues = std::vector<WorkStealingDeque<Task>>(numThreads);
+    } else if (queueKind == TaskQueueKind::lock_free) {
+      lockFreeTasks = std::make_unique<MPMCQueue<Task>>(queueCapacity);
+    }
+    liveWorkers.store(numThreads, std::memory_order_relaxed);
+    workerSlots = elastic ? std::max(numThreads, maxThreads) : numThreads;
+    workerMetrics = std::make_unique<WorkerMetrics[]>(workerSlots);
+    // (elastic) `grow()` never reallocates it
+    threads.reserve(workerSlots);
     for (std::size_t i = 0; i < numThreads; ++i) [[likely]] {
-      threads.emplace_back([&]() {
-        for (;;) [[likely]] {
-          std::function<void()> task;
-          // 1. Try to get a task from the queue.
-
-          // In this field, the queue should be exclusive instead of shared.
-          // So we need to lock the queue.
-          /* begin of field */
-          {
-            // lock the queue
-            std::unique_lock<std::mutex> lock(queueMutex);
-            // wait when `the queue is empty` and `not stopped`
-            condition.wait(lock, [&]() { return stop || !tasks.empty(); });
-            if (stop && tasks.empty()) [[unlikely]] {
-              return;
-            }
-            task = std::move(tasks.front());
-            tasks.pop();
+      threads.emplace_back([this, i]() { run_worker(i); });
+    }
+  }
+
+  void run_worker(std::size_t index) {
+    worker_loop(index);
+    if (elastic) {
+      // retired (or stopped) => the next `grow()` reuses and joins the slot
+      std::lock_guard<std::mutex> lock(threadsMutex);
+      freeSlots.emplace_back(index);
+    }
+  }
+
+  /// @brief decide the CPUs (and the NUMA node) of every worker
+  void place_workers(std::size_t numThreads) {
+    if (placement == WorkerPlacement::pinned) {
+      // (elastic) a slot could be reused by any worker up to `maxThreads`
+      numThreads = std::max(numThreads, maxThreads);
+      // (CPU `i` may be out of the affinity mask => pinning would fail)
+      const auto &targets = cpus.empty() ? CpuTopology::allowed_cpus() : cpus;
+      workerCpus.resize(numThreads);
+      for (std::size_t i = 0; i < numThreads; ++i) [[likely]] {
+        workerCpus[i] = {targets[i % targets.size()]};
+      }
+    } else if (placement == WorkerPlacement::numa_spread) {
+      auto topology = CpuTopology::detect();
+      nodeQueues = std::vector<WorkStealingDeque<Task>>(topology.nodes.size());
+      workerCpus.resize(numThreads);
+      workerNodes.resize(numThreads);
+      for (std::size_t i = 0; i < numThreads; ++i) [[likely]] {
+        workerNodes[i] = i % topology.nodes.size();
+        workerCpus[i] = topology.nodes[workerNodes[i]];
+      }
+    }
+  }
+
+  void worker_loop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    if (!workerCpus.empty()) {
+      // best effort: a rejected mask just leaves the worker where it is
+      pin_current_thread(workerCpus[index]);
+    }
+    auto &stats = workerMetrics[index];
+    auto lastEnd = collectTimings ? now_ticks() : 0;
+    for (;;) [[likely]] {
+      Task task;
+      // 1. Try to get a task from the queue(s).
+      if (workStealing) {
+        if (!next_stolen_or_local_task(index, task)) [[unlikely]] {
+          return;
+        }
+      } else if (lockFreeTasks) {
+        if (!next_lock_free_task(task)) [[unlikely]] {
+          return;
+        }
+      } else {
+        // the queue looks empty => spin a while before blocking on the lock
+        if (queuedTasks.load(std::memory_order_relaxed) == 0) [[unlikely]] {
+          spin_for_work();
+        }
+        // In this field, the queue should be exclusive instead of shared.
+        // So we need to lock the queue.
+        /* begin of field */
+        // lock the queue
+        std::unique_lock<std::mutex> lock(queueMutex);
+        // wait when `the queue is empty` and `not stopped`
+        // (elastic => give up after `idleTimeout` and retire)
+        if (!idle_wait(lock, [&]() { return stop || !tasks.empty(); }))
+            [[unlikely]] {
+          return;
+        }
+        // most urgent level first (or an aged task)
+        if (!tasks.try_pop(task)) [[unlikely]] {
+          return;
+        }
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        note_dequeue();
+        /* end of field */
+        // We should end this field == We should release the lock.
+        // That's because we hope to see the `task queue` is shared for IO at
+        // most time.
+        // Clearly, the lock after waiting is totally unnecessary.
+      }
+
+      // 2. execute the task (fetched from the queue's front)
+      release_slot();
+      stats.running.store(true, std::memory_order_relaxed);
+      if (collectTimings) {
+        auto start = now_ticks();
+        stats.queueWait.record(nanos_between(task.enqueuedAt, start));
+        bump(stats.idleNanos, nanos_between(lastEnd, start));
+        execute(task);
+        lastEnd = now_ticks();
+        bump(stats.busyNanos, nanos_between(start, lastEnd));
+      } else {
+        execute(task);
+      }
+      stats.running.store(false, std::memory_order_relaxed);
+      bump(stats.tasksExecuted, 1);
+      finish_task();
+    }
+  }
+
+  /// @brief `count` more tasks are about to be queued (=> `wait_idle()`)
+  void add_unfinished(std::size_t count) {
+    unfinishedTasks.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /// @brief one queued task is done => wake `wait_idle()` on the last one
+  void finish_task() {
+    if (unfinishedTasks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        [[unlikely]] {
+      unfinishedTasks.notify_all();
+    }
+  }
+
+  /**
+   * @brief take a queued task without waiting (see `run_pending_task()`)
+   *
+   * @param task
+   * @return false <=> nothing visible to take
+   */
+  bool try_take_task(Task &task) {
+    if (workStealing) {
+      if (currentPool == this) {
+        if (localQueues[currentIndex].try_pop(task) ||
+            try_steal(currentIndex, task)) [[likely]] {
+          return true;
+        }
+      } else {
+        for (auto &queue : localQueues) [[likely]] {
+          if (queue.try_steal(task)) {
+            return true;
           }
-          /* end of field */
-          // We should end this field == We should release the lock.
-          // That's because we hope to see the `task queue` is shared for IO at
-          // most time.
-          // Clearly, the lock after waiting is totally unnecessary.
+        }
+        for (auto &queue : nodeQueues) [[likely]] {
+          if (queue.try_steal(task)) {
+            return true;
+          }
+        }
+      }
+    } else if (lockFreeTasks && lockFreeTasks->try_pop(task)) {
+      note_dequeue();
+      return true;
+    }
+    // (locked mode: the shared queue itself)
+    return try_pop_prioritized(task, TaskPriority::low);
+  }
+
+  /// @brief add `delta` to a counter only its own worker writes
+  ///        (a plain load / store, no locked instruction)
+  static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+  }
+
+  /// @brief nanoseconds from `from` to `to` (`now_ticks()`), at least 0
+  static std::uint64_t nanos_between(std::int64_t from, std::int64_t to) {
+    if (to <= from) [[unlikely]] {
+      return 0;
+    }
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::duration{to - from})
+            .count());
+  }
+
+  /// @brief (timings / tracing only) remember when `task` was queued
+  void stamp(Task &task) {
+    if (collectTimings) {
+      task.enqueuedAt = now_ticks();
+    }
+    trace_enqueue(task);
+  }
+
+  /// @brief run a dequeued task (between two trace events when tracing)
+  void execute(Task &task) {
+    trace_event(TraceKind::start, task);
+    task();
+    trace_event(TraceKind::finish, task);
+  }
+
+  /// @brief (tracing only) give `task` its id and record its enqueue
+  void trace_enqueue([[maybe_unused]] Task &task) {
+#if EDEN_THREAD_POOL_TRACE
+    task.traceId = tracer.next_task_id();
+    trace_event(TraceKind::enqueue, task);
+#endif
+  }
+
+  /// @brief (tracing only) record `kind` for `task` on the calling thread
+  void trace_event([[maybe_unused]] TraceKind kind,
+                   [[maybe_unused]] const Task &task) {
+#if EDEN_THREAD_POOL_TRACE
+    trace_event(kind, task.traceId);
+#endif
+  }
+
+  /// @brief (tracing only) record `kind` (`task` = 0 if none)
+  void trace_event([[maybe_unused]] TraceKind kind,
+                   [[maybe_unused]] std::uint64_t task = 0) {
+#if EDEN_THREAD_POOL_TRACE
+    tracer.record(kind, task,
+                  currentPool == this ? static_cast<long>(currentIndex) : -1);
+#endif
+  }
+
+  /**
+   * @brief (work-stealing mode) fetch the next task for worker `index`
+   *        => own deque first, then steal from the others, then park
+   *
+   * @param index
+   * @param task
+   * @return false <=> the pool is stopped and every deque is drained
+   */
+  bool next_stolen_or_local_task(std::size_t index, Task &task) {
+    for (;;) [[likely]] {
+      if (try_pop_prioritized(task, TaskPriority::high)) [[unlikely]] {
+        return true;
+      }
+      if (localQueues[index].try_pop(task)) [[likely]] {
+        return true;
+      }
+      if (try_steal(index, task)) {
+        bump(workerMetrics[index].steals, 1);
+        return true;
+      }
+      if (try_pop_prioritized(task, TaskPriority::low)) [[unlikely]] {
+        return true;
+      }
+      if (spin_for_work()) {
+        continue;
+      }
+      // nothing to do => park until someone pushes (or the pool stops)
+      if (!park()) [[unlikely]] {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * @brief (lock-free mode) fetch the next task from `lockFreeTasks`
+   *
+   * @param task
+   * @return false <=> the pool is stopped and the queue is drained
+   */
+  bool next_lock_free_task(Task &task) {
+    for (;;) [[likely]] {
+      if (try_pop_prioritized(task, TaskPriority::high)) [[unlikely]] {
+        return true;
+      }
+      if (lockFreeTasks->try_pop(task)) [[likely]] {
+        note_dequeue();
+        return true;
+      }
+      if (try_pop_prioritized(task, TaskPriority::low)) [[unlikely]] {
+        return true;
+      }
+      if (spin_for_work()) {
+        continue;
+      }
+      if (!park()) [[unlikely]] {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * @brief (work-stealing / lock-free mode) pop a task of priority `lowest`
+   *        or more urgent (or an aged one) from `tasks`
+   *
+   *        There, `tasks` only holds the tasks submitted with a priority
+   *        other than `normal`: `high` ones are looked for before the usual
+   *        queues, `low` ones only once those are empty.
+   *
+   * @param task
+   * @param lowest
+   * @return false <=> nothing eligible
+   */
+  bool try_pop_prioritized(Task &task, TaskPriority lowest) {
+    if (queuedTasks.load(std::memory_order_relaxed) == 0) [[likely]] {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!tasks.try_pop(task, static_cast<std::size_t>(lowest))) {
+      return false;
+    }
+    queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    note_dequeue();
+    return true;
+  }
+
+  /**
+   * @brief busy-wait (then yield) as `idle` says, until a task shows up
+   *
+   * @return false <=> nothing showed up (or the pool stops) => the caller
+   * should park
+   */
+  bool spin_for_work() const {
+    for (std::size_t i = 0; i < idle.spins + idle.yields; ++i) [[likely]] {
+      if (stop.load(std::memory_order_relaxed)) [[unlikely]] {
+        return false;
+      }
+      if (has_visible_work()) [[unlikely]] {
+        return true;
+      }
+      if (i < idle.spins) [[likely]] {
+        cpu_relax();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    return false;
+  }
+
+  /// @brief whether any queue holds a task (checked without any lock)
+  [[nodiscard]] bool has_visible_work() const {
+    return queuedTasks.load(std::memory_order_relaxed) != 0 ||
+           has_lock_free_tasks();
+  }
+
+  /**
+   * @brief (work-stealing / lock-free mode) sleep on `condition` until a
+   *        lock-free queue becomes non-empty or the pool stops
+   *
+   * @return false <=> the pool is stopped and there is nothing left to run
+   * (or, elastic, the worker should retire)
+   */
+  bool park() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+    auto woken =
+        idle_wait(lock, [&]() { return stop || has_visible_work(); });
+    sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+    return woken && (!stop || has_visible_work());
+  }
+
+  /**
+   * @brief `condition.wait(lock, pred)`, except that an elastic pool gives
+   *        up after `idleTimeout` without work if it may retire the worker
+   *
+   * @tparam Pred
+   * @param lock
+   * @param pred
+   * @return false <=> the worker is retired (and must exit)
+   */
+  template <typename Pred>
+  bool idle_wait(std::unique_lock<std::mutex> &lock, Pred pred) {
+    if (pred()) [[likely]] {
+      return true;
+    }
+    if (currentPool == this) [[likely]] {
+      bump(workerMetrics[currentIndex].parks, 1);
+    }
+    idleWorkers.fetch_add(1, std::memory_order_relaxed);
+    trace_event(TraceKind::park);
+    struct Leave {
+      ThreadPool &pool;
+      ~Leave() {
+        pool.idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+        pool.trace_event(TraceKind::wake);
+      }
+    } leave{*this};
+    if (!elastic) {
+      condition.wait(lock, pred);
+      return true;
+    }
+    while (!pred()) [[likely]] {
+      if (condition.wait_for(lock, idleTimeout) == std::cv_status::timeout &&
+          !pred() && try_retire()) [[unlikely]] {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// @brief (elastic) take one worker off `liveWorkers` unless at `minThreads`
+  bool try_retire() {
+    auto live = liveWorkers.load(std::memory_order_relaxed);
+    while (live > minThreads) [[likely]] {
+      if (liveWorkers.compare_exchange_weak(live, live - 1,
+                                            std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief (elastic) remember that a worker just took a task
+  void note_dequeue() {
+    if (elastic) {
+      lastDequeue.store(now_ticks(), std::memory_order_relaxed);
+    }
+  }
+
+  static std::int64_t now_ticks() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+  }
+
+  /// @brief (elastic) start one more worker if the queue backs up
+  void maybe_grow() {
+    if (!elastic) [[likely]] {
+      return;
+    }
+    if (liveWorkers.load(std::memory_order_relaxed) >= maxThreads) [[likely]] {
+      return;
+    }
+    // idle workers (even if not awake yet) will take that many tasks
+    auto depth = remaining_tasks_num();
+    auto idle = idleWorkers.load(std::memory_order_relaxed);
+    if (depth <= idle) [[likely]] {
+      return;
+    }
+    auto waited = std::chrono::steady_clock::duration{
+        now_ticks() - lastDequeue.load(std::memory_order_relaxed)};
+    if (depth - idle > growQueueDepth || (idle == 0 && waited > growWaitTime)) {
+      grow();
+    }
+  }
+
+  /// @brief (elastic) start one worker (in a retired slot if there is one)
+  void grow() {
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    if (stop || liveWorkers.load(std::memory_order_relaxed) >= maxThreads)
+        [[unlikely]] {
+      return;
+    }
+    if (freeSlots.empty() && threads.size() >= workerSlots) [[unlikely]] {
+      // a retired worker has not handed its slot back yet => next time
+      return;
+    }
+    liveWorkers.fetch_add(1, std::memory_order_relaxed);
+    // don't count the queue as stale again before the new worker shows up
+    lastDequeue.store(now_ticks(), std::memory_order_relaxed);
+    if (freeSlots.empty()) {
+      auto index = threads.size();
+      threads.emplace_back([this, index]() { run_worker(index); });
+      return;
+    }
+    auto index = freeSlots.back();
+    freeSlots.pop_back();
+    // the retired worker has left `worker_loop()` => joins right away
+    threads[index].join();
+    threads[index] = std::thread([this, index]() { run_worker(index); });
+  }
+
+  /// @brief whether `lockFreeTasks` or any worker's deque is non-empty
+  [[nodiscard]] bool has_lock_free_tasks() const {
+    if (lockFreeTasks && !lockFreeTasks->empty()) [[unlikely]] {
+      return true;
+    }
+    return has_local_tasks();
+  }
+
+  /// @brief try to steal a task from any other worker's deque
+  ///        (NUMA mode: own node's queue, then own node's workers, then the
+  ///        other nodes' queues, and only then any worker at all)
+  bool try_steal(std::size_t index, Task &task) {
+    const std::size_t n = localQueues.size();
+    if (!nodeQueues.empty()) {
+      const std::size_t node = workerNodes[index];
+      if (nodeQueues[node].try_steal(task)) [[likely]] {
+        return true;
+      }
+      for (std::size_t k = 1; k < n; ++k) [[likely]] {
+        auto victim = (index + k) % n;
+        if (workerNodes[victim] == node &&
+            localQueues[victim].try_steal(task)) [[unlikely]] {
+          return true;
+        }
+      }
+      for (std::size_t k = 1; k < nodeQueues.size(); ++k) [[likely]] {
+        if (nodeQueues[(node + k) % nodeQueues.size()].try_steal(task))
+            [[unlikely]] {
+          return true;
+        }
+      }
+    }
+    for (std::size_t k = 1; k < n; ++k) [[likely]] {
+      if (localQueues[(index + k) % n].try_steal(task)) [[unlikely]] {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief whether any worker's (or NUMA node's) deque is non-empty
+  [[nodiscard]] bool has_local_tasks() const {
+    for (const auto &queue : localQueues) [[likely]] {
+      if (!queue.empty()) [[unlikely]] {
+        return true;
+      }
+    }
+    for (const auto &queue : nodeQueues) [[likely]] {
+      if (!queue.empty()) [[unlikely]] {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief (work-stealing / lock-free mode) wake up to `count` parked workers
+  void wake_sleeping(std::size_t count = 1) {
+    // pairs with `sleepingWorkers.fetch_add()` in `park()`: either the
+    // parking worker sees the new task, or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto sleeping = sleepingWorkers.load(std::memory_order_seq_cst);
+    if (sleeping == 0) [[likely]] {
+      return;
+    }
+    // the sleeper holds `queueMutex` until it really waits
+    { std::lock_guard<std::mutex> lock(queueMutex); }
+    notify(std::min(count, sleeping));
+  }
+
+  /// @brief wake `count` workers waiting on `condition`
+  ///        (never reads `threads`, which an elastic `grow()` may change)
+  void notify(std::size_t count) {
+    if (count >= workerSlots) {
+      condition.notify_all();
+      return;
+    }
+    for (std::size_t i = 0; i < count; ++i) [[likely]] {
+      condition.notify_one();
+    }
+  }
+
+  /// @brief (lock-free mode) push `task`, waiting for room if the queue is full
+  void push_lock_free(Task &&task) {
+    while (!lockFreeTasks->try_push(std::move(task))) [[unlikely]] {
+      if (currentPool == this) {
+        // a worker waiting for room in its own full queue could wait
+        // forever => run the task right here instead
+        release_slot();
+        execute(task);
+        finish_task();
+        return;
+      }
+      // the batch we are pushing may still wait for its wake-up
+      wake_sleeping(workerSlots);
+      std::this_thread::yield();
+    }
+  }
+
+  /// @brief push a wrapped task into the proper queue and wake a worker
+  ///        (bounded => once `admit()` made room for it)
+  void push_task(Task task, TaskPriority priority = TaskPriority::normal) {
+    if (maxQueuedTasks == 0) [[likely]] {
+      push_admitted(std::move(task), priority);
+      return;
+    }
+    if (!admit(task)) {
+      return;
+    }
+    try {
+      push_admitted(std::move(task), priority);
+    } catch (...) {
+      release_slot();
+      throw;
+    }
+  }
+
+  /**
+   * @brief (bounded) take a queue slot for `task`, applying `overflow` if
+   *        the queue is full
+   *
+   * @param task
+   * @return false <=> `task` was run right here instead (=> don't push it)
+   */
+  bool admit(Task &task) {
+    if (try_reserve_slot()) [[likely]] {
+      return true;
+    }
+    if (timerPool == this) [[unlikely]] {
+      // the timer thread must neither block nor run user tasks => the due
+      // task is queued anyway, past the bound
+      queuedSlots.fetch_add(1, std::memory_order_seq_cst);
+      return true;
+    }
+    switch (overflow) {
+      case OverflowPolicy::block:
+        if (currentPool != this) {
+          wait_for_slot();
+          return true;
+        }
+        [[fallthrough]];
+      case OverflowPolicy::caller_runs:
+        task();
+        return false;
+      case OverflowPolicy::drop_oldest:
+        while (!try_reserve_slot()) [[unlikely]] {
+          drop_oldest();
+        }
+        return true;
+      case OverflowPolicy::reject:
+        break;
+    }
+    throw std::runtime_error("enqueue on full ThreadPool");
+  }
+
+  /// @brief (bounded) take a queue slot if one is free
+  bool try_reserve_slot() {
+    auto queued = queuedSlots.load(std::memory_order_relaxed);
+    while (queued < maxQueuedTasks) [[likely]] {
+      if (queuedSlots.compare_exchange_weak(queued, queued + 1,
+                                            std::memory_order_seq_cst)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief (bounded) block until a queue slot is taken
+  void wait_for_slot() {
+    blockedProducers.fetch_add(1, std::memory_order_seq_cst);
+    // pairs with `release_slot()`: either it sees us, or we see its release
+    while (!try_reserve_slot()) [[unlikely]] {
+      auto queued = queuedSlots.load(std::memory_order_seq_cst);
+      if (queued >= maxQueuedTasks) {
+        queuedSlots.wait(queued, std::memory_order_seq_cst);
+      }
+    }
+    blockedProducers.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// @brief (bounded) a queued task left the queue => free its slot
+  void release_slot() {
+    if (maxQueuedTasks == 0) [[likely]] {
+      return;
+    }
+    queuedSlots.fetch_sub(1, std::memory_order_seq_cst);
+    if (blockedProducers.load(std::memory_order_seq_cst) != 0) [[unlikely]] {
+      queuedSlots.notify_all();
+    }
+  }
+
+  /// @brief (`drop_oldest`) drop one queued task, least urgent first
+  void drop_oldest() {
+    Task victim;
+    if (!try_evict(victim)) [[unlikely]] {
+      // every queued task was just taken (or is not pushed yet)
+      std::this_thread::yield();
+      return;
+    }
+    release_slot();
+    finish_task();
+    // (destroying `victim` breaks its promise)
+  }
+
+  /// @brief take the oldest task of the least urgent priority out of the
+  ///        queues, without running it
+  bool try_evict(Task &victim) {
+    if (try_pop_least_urgent(victim, TaskPriority::low)) {
+      return true;
+    }
+    if (lockFreeTasks && lockFreeTasks->try_pop(victim)) {
+      return true;
+    }
+    // (`try_steal()` takes the oldest end of a deque)
+    for (auto &queue : localQueues) [[likely]] {
+      if (queue.try_steal(victim)) {
+        return true;
+      }
+    }
+    for (auto &queue : nodeQueues) [[likely]] {
+      if (queue.try_steal(victim)) {
+        return true;
+      }
+    }
+    return try_pop_least_urgent(victim, TaskPriority::high);
+  }
+
+  /// @brief pop from `tasks`, least urgent level first, down to `mostUrgent`
+  bool try_pop_least_urgent(Task &task, TaskPriority mostUrgent) {
+    if (queuedTasks.load(std::memory_order_relaxed) == 0) [[likely]] {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!tasks.try_pop_least_urgent(task,
+                                    static_cast<std::size_t>(mostUrgent))) {
+      return false;
+    }
+    queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// @brief `push_task()` once the task has a queue slot (if bounded)
+  void push_admitted(Task task, TaskPriority priority) {
+    stamp(task);
+    if (priority != TaskPriority::normal && (workStealing || lockFreeTasks)) {
+      push_prioritized(std::move(task), priority);
+      return;
+    }
+    if (workStealing) {
+      if (currentPool == this) {
+        // submitted from one of our workers => keep it local
+        add_unfinished(1);
+        localQueues[currentIndex].push(std::move(task));
+      } else {
+        if (stop) [[unlikely]] {
+          throw std::runtime_error("enqueue on stopped ThreadPool");
+        }
+        add_unfinished(1);
+        auto target = nextQueue.fetch_add(1, std::memory_order_relaxed);
+        localQueues[target % localQueues.size()].push(std::move(task));
+      }
+      wake_sleeping();
+      return;
+    }
+    if (lockFreeTasks) {
+      if (stop) [[unlikely]] {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+      }
+      add_unfinished(1);
+      push_lock_free(std::move(task));
+      wake_sleeping();
+      maybe_grow();
+      return;
+    }
+    // (needs to change the queue from `shared` to `exclusive`)
+    // (otherwise, the queue could be changed by multiple threads)
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      if (stop) [[unlikely]] {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+      }
+      add_unfinished(1);
+      tasks.push(static_cast<std::size_t>(priority), std::move(task));
+      queuedTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    condition.notify_one();
+    maybe_grow();
+  }
+
+  /// @brief (work-stealing / lock-free mode) push a task with a priority
+  ///        other than `normal` into `tasks`
+  void push_prioritized(Task task, TaskPriority priority) {
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      if (stop) [[unlikely]] {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+      }
+      add_unfinished(1);
+      tasks.push(static_cast<std::size_t>(priority), std::move(task));
+      queuedTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_sleeping();
+    maybe_grow();
+  }
+
+  /// @brief push a wrapped task into the queue of NUMA node `node`
+  ///        (falls back to `push_task()` outside NUMA mode)
+  void push_task_on(std::size_t node, Task task) {
+    if (nodeQueues.empty()) {
+      push_task(std::move(task));
+      return;
+    }
+    if (stop) [[unlikely]] {
+      throw std::runtime_error("enqueue on stopped ThreadPool");
+    }
+    if (maxQueuedTasks != 0 && !admit(task)) {
+      return;
+    }
+    stamp(task);
+    add_unfinished(1);
+    nodeQueues[node % nodeQueues.size()].push(std::move(task));
+    // any sleeper will do: one from another node still finds the task after
+    // its own node ran dry, so the hint never starves a task
+    wake_sleeping();
+  }
+
+  /// @brief push a whole batch at once, then wake as many workers as needed
+  void push_tasks(std::vector<Task> batch) {
+    if (batch.empty()) [[unlikely]] {
+      return;
+    }
+    if (maxQueuedTasks != 0) {
+      // a batch may not fit at once => one slot (and policy) per task
+      for (auto &task : batch) [[likely]] {
+        push_task(std::move(task));
+      }
+      return;
+    }
+    const std::size_t count = batch.size();
+    if (collectTimings) {
+      auto now = now_ticks();
+      for (auto &task : batch) [[likely]] {
+        task.enqueuedAt = now;
+      }
+    }
+#if EDEN_THREAD_POOL_TRACE
+    for (auto &task : batch) [[likely]] {
+      trace_enqueue(task);
+    }
+#endif
+    if (workStealing) {
+      if (currentPool == this) {
+        add_unfinished(count);
+        localQueues[currentIndex].push_bulk(batch.begin(), batch.end());
+      } else {
+        if (stop) [[unlikely]] {
+          throw std::runtime_error("enqueue on stopped ThreadPool");
+        }
+        add_unfinished(count);
+        // hand every deque one contiguous slice (one lock per deque)
+        const std::size_t n = localQueues.size();
+        const std::size_t slice = (count + n - 1) / n;
+        auto target = nextQueue.fetch_add(n, std::memory_order_relaxed);
+        for (std::size_t begin = 0; begin < count; begin += slice) {
+          auto end = std::min(begin + slice, count);
+          localQueues[target++ % n].push_bulk(batch.begin() + begin,
+                                              batch.begin() + end);
+        }
+      }
+      wake_sleeping(count);
+      return;
+    }
+    if (lockFreeTasks) {
+      if (stop) [[unlikely]] {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+      }
+      add_unfinished(count);
+      for (auto &task : batch) [[likely]] {
+        push_lock_free(std::move(task));
+      }
+      wake_sleeping(count);
+      maybe_grow();
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      if (stop) [[unlikely]] {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+      }
+      add_unfinished(count);
+      tasks.push_bulk(static_cast<std::size_t>(TaskPriority::normal),
+                      batch.begin(), batch.end());
+      queuedTasks.fetch_add(count, std::memory_order_relaxed);
+    }
+    notify(count);
+    maybe_grow();
+  }
+
+  /// @brief run `action` on the timer thread once `due` has passed
+  ///        (the timer thread is started by the first timer)
+  void schedule_timer(TimerWheel::Clock::time_point due, UniqueTask action) {
+    {
+      std::lock_guard<std::mutex> lock(timerMutex);
+      if (stop || timerStop) [[unlikely]] {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+      }
+      if (!timers) [[unlikely]] {
+        timers = std::make_unique<TimerWheel>(timerTick);
+        timerThread = std::thread([this]() { timer_loop(); });
+      }
+      timers->schedule(due, std::move(action));
+    }
+    // (might be due before the current sleep ends)
+    timerCondition.notify_one();
+  }
+
+  /// @brief sleep until the next timer is due, fire it, repeat
+  void timer_loop() {
+    timerPool = this;
+    std::vector<UniqueTask> fired{};
+    std::unique_lock<std::mutex> lock(timerMutex);
+    while (!timerStop) [[likely]] {
+      auto wake = timers->next_wake();
+      if (wake) {
+        timerCondition.wait_until(lock, *wake);
+      } else {
+        timerCondition.wait(lock);
+      }
+      timers->advance(TimerWheel::Clock::now(), fired);
+      if (fired.empty()) {
+        continue;
+      }
+      // the actions only queue tasks (or re-arm timers), bypassing the
+      // overflow policy (see `admit()`) => never block long
+      lock.unlock();
+      for (auto &action : fired) [[likely]] {
+        try {
+          action();
+        } catch (...) {
+          // rejected (stopped pool): the task is dropped, its promise broken
+        }
+      }
+      fired.clear();
+      lock.lock();
+    }
+  }
+
+  /**
+   * @brief state of a task queued by `enqueue_every()`
+   *
+   * @tparam T
+   */
+  template <typename T>
+  struct Periodic {
+    T task;
+    TimerWheel::Clock::time_point due;
+    TimerWheel::Clock::duration period;
+    TimerHandle handle;
+    /// @brief whether the previous run is still queued or running
+    std::atomic<bool> busy = false;
+  };
+
+  /// @brief queue one run of `state` at `state->due` (skipped if the
+  ///        previous one is not done yet), then re-arm for the next period
+  template <typename T>
+  void arm_periodic(std::shared_ptr<Periodic<T>> state) {
+    auto due = state->due;
+    schedule_timer(due, [this, state = std::move(state)]() mutable {
+      if (state->handle.cancelled()) [[unlikely]] {
+        return;
+      }
+      if (!state->busy.exchange(true, std::memory_order_acq_rel)) {
+        try {
+          push_task([state]() noexcept {
+            if (!state->handle.cancelled()) [[likely]] {
+              state->task();
+            }
+            state->busy.store(false, std::memory_order_release);
+          });
+        } catch (...) {
+          // rejected (stopped pool) => skip this run only
+          state->busy.store(false, std::memory_order_release);
+        }
+      }
+      // fixed rate: late runs do not shift the following ones
+      state->due += state->period;
+      arm_periodic(std::move(state));
+    });
+  }
+
+  /// @brief stop the timer thread (the pending timers are dropped)
+  void stop_timers() {
+    {
+      std::lock_guard<std::mutex> lock(timerMutex);
+      timerStop = true;
+    }
+    timerCondition.notify_one();
+    if (timerThread.joinable()) {
+      timerThread.join();
+    }
+    timers.reset();
+  }
 
-          // 2. execute the task (fetched from the queue's front)
-          task();
-        }
-      });
+  /**
+   * @brief stop the pool (once) and join the workers, which finish their
+   *        current task and then whatever is still queued
+   *
+   * @param taken if not null, the queued tasks are moved there first
+   */
+  void stop_and_join(std::vector<Task> *taken) {
+    if (currentPool == this) [[unlikely]] {
+      throw std::logic_error("ThreadPool shut down from one of its workers");
+    }
+    std::lock_guard<std::mutex> shutdownLock(shutdownMutex);
+    if (shutDown) {
+      return;
+    }
+    shutDown = true;
+    // no timer fires into a stopping pool
+    stop_timers();
+    // set status to stop (and, discarding, empty the queues in the same
+    // critical section => no worker woken by `stop` finds a task to run)
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      stop = true;
+      if (taken != nullptr) {
+        take_queued(*taken);
+      }
+    }
+    condition.notify_all();  // notify all threads to stop
+    // (elastic) a `grow()` in flight is done once we get the lock
+    { std::lock_guard<std::mutex> lock(threadsMutex); }
+    // wait for all threads to stop
+    for (auto &thread : threads) [[likely]] {
+      thread.join();
+    }
+  }
+
+  /// @brief move every queued task (not started yet) to `taken`
+  ///        (`queueMutex` must be held)
+  void take_queued(std::vector<Task> &taken) {
+    auto take = [&](Task &&task) {
+      taken.emplace_back(std::move(task));
+      release_slot();
+      finish_task();
+    };
+    Task task;
+    while (tasks.try_pop(task)) [[likely]] {
+      queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+      take(std::move(task));
+    }
+    while (lockFreeTasks && lockFreeTasks->try_pop(task)) [[likely]] {
+      take(std::move(task));
+    }
+    // (`try_pop()` locks, where `try_steal()` could give up on contention)
+    for (auto &queue : localQueues) [[likely]] {
+      while (queue.try_pop(task)) [[likely]] {
+        take(std::move(task));
+      }
+    }
+    for (auto &queue : nodeQueues) [[likely]] {
+      while (queue.try_pop(task)) [[likely]] {
+        take(std::move(task));
+      }
     }
   }
 
  public:
   /// @brief Construct a new Thread Pool object (with a given number of threads)
-  explicit ThreadPool(std::size_t numThreads) {
+  explicit ThreadPool(std::size_t numThreads)
+      : ThreadPool(ThreadPoolOptions{.numThreads = numThreads}) {}
+
+  /// @brief Construct a new Thread Pool object (with `hardware_concurrency()`)
+  ThreadPool() : ThreadPool(ThreadPoolOptions{}) {}
+
+  /// @brief Construct a new Thread Pool object (with given `options`)
+  explicit ThreadPool(const ThreadPoolOptions &options)
+      : workStealing(options.workStealing ||
+                     options.placement == WorkerPlacement::numa_spread),
+        queueKind(options.queueKind),
+        queueCapacity(options.queueCapacity),
+        placement(options.placement),
+        cpus(options.cpus),
+        idle(options.idle),
+        elastic(options.elastic),
+        minThreads(std::max<std::size_t>(options.minThreads, 1)),
+        maxThreads(options.maxThreads),
+        growQueueDepth(options.growQueueDepth),
+        growWaitTime(options.growWaitTime),
+        idleTimeout(options.idleTimeout),
+        collectTimings(options.collectTimings),
+        timerTick(options.timerTick),
+#if EDEN_THREAD_POOL_TRACE
+        tracer(options.traceEvents),
+#endif
+        overflow(options.overflow),
+        maxQueuedTasks(options.maxQueuedTasks) {
+    tasks.set_aging(options.priorityAging);
+    if (elastic) {
+      if (workStealing) [[unlikely]] {
+        throw std::invalid_argument(
+            "elastic ThreadPool needs a shared queue (no work stealing)");
+      }
+      if (maxThreads == 0) {
+        maxThreads = std::max(1U, std::thread::hardware_concurrency());
+      }
+      maxThreads = std::max(maxThreads, minThreads);
+    }
+    if (std::thread::hardware_concurrency() <= 1) [[unlikely]] {
+      // spinning would only steal the single core from the submitter
+      idle.spins = 0;
+    }
+    std::size_t numThreads = options.numThreads;
     if (numThreads > std::thread::hardware_concurrency()) [[unlikely]] {
       std::cout << "Warning: The number of threads is larger than the number "
                    "of hardware concurrency.\n\n";
       std::cout << "Now, automatically set it to the concurrency.\n\n";
       numThreads = std::thread::hardware_concurrency();
     }
+    if (elastic) {
+      numThreads = std::clamp(numThreads, minThreads, maxThreads);
+    }
     init_threads(numThreads);
   }
 
-  /// @brief Construct a new Thread Pool object (with `hardware_concurrency()`)
-  ThreadPool() { init_threads(std::thread::hardware_concurrency()); }
-
   template <typename T>
   auto enqueue(T task) -> std::future<decltype(task())> {
     // A future object is a handle to a value that is not yet available.
@@ -78,82 +1312,584 @@ class ThreadPool {
 
     // 1. wrap the task into a packaged_task
     // (will automatically create a future object)
-    auto wrapper = std::make_shared<std::packaged_task<decltype(task())()>>(
-        std::move(task));
-    // 2. push the task into the queue
-    // (needs to change the queue from `shared` to `exclusive`)
-    // (otherwise, the queue could be changed by multiple threads)
-    {
-      std::unique_lock<std::mutex> lock(queueMutex);
-      if (stop) [[unlikely]] {
-        throw std::runtime_error("enqueue on stopped ThreadPool");
+    std::packaged_task<decltype(task())()> wrapper{std::move(task)};
+    // 2. fetch the connected future object before any worker could run it
+    auto future = wrapper.get_future();
+    // 3. push the task into the queue and notify one thread to execute it
+    // (`UniqueTask` is move-only, so the packaged_task is moved in as is)
+    push_task(std::move(wrapper));
+    // 4. return the connected future object
+    return future;
+  }
+
+  /**
+   * @brief `enqueue(task)` unless the queue is full (`maxQueuedTasks`),
+   *        whatever the overflow policy, and without ever blocking
+   *
+   * @tparam T
+   * @param task
+   * @return std::optional<std::future<decltype(task())>> empty <=> full
+   */
+  template <typename T>
+  auto try_enqueue(T task) -> std::optional<std::future<decltype(task())>> {
+    if (maxQueuedTasks != 0 && !try_reserve_slot()) {
+      return std::nullopt;
+    }
+    std::packaged_task<decltype(task())()> wrapper{std::move(task)};
+    auto future = wrapper.get_future();
+    try {
+      push_admitted(std::move(wrapper), TaskPriority::normal);
+    } catch (...) {
+      release_slot();
+      throw;
+    }
+    return future;
+  }
+
+  /**
+   * @brief `enqueue(task)` with a priority
+   *        => `high` tasks run before `normal` ones, which run before `low`
+   *        ones (a task passed over too long still runs, see `priorityAging`)
+   *
+   * @tparam T
+   * @param priority
+   * @param task
+   * @return std::future<decltype(task())>
+   */
+  template <typename T>
+  auto enqueue(TaskPriority priority, T task)
+      -> std::future<decltype(task())> {
+    std::packaged_task<decltype(task())()> wrapper{std::move(task)};
+    auto future = wrapper.get_future();
+    push_task(std::move(wrapper), priority);
+    return future;
+  }
+
+  /**
+   * @brief `enqueue(task)` with a hint to run `task` on NUMA node `node`
+   *        (near its data) => ignored unless the placement is `numa_spread`
+   *
+   * @tparam T
+   * @param node
+   * @param task
+   * @return std::future<decltype(task())>
+   */
+  template <typename T>
+  auto enqueue_on(std::size_t node, T task) -> std::future<decltype(task())> {
+    std::packaged_task<decltype(task())()> wrapper{std::move(task)};
+    auto future = wrapper.get_future();
+    push_task_on(node, std::move(wrapper));
+    return future;
+  }
+
+  /**
+   * @brief `enqueue(task)` once `delay` has passed
+   *
+   *        No thread sleeps per timer: every delayed task sits in one
+   *        hierarchical timer wheel, driven by a single timer thread which
+   *        only queues the due tasks (they run on the workers as usual).
+   *
+   * @tparam Rep
+   * @tparam Period
+   * @tparam T
+   * @param delay
+   * @param task
+   * @return std::future<decltype(task())> (broken if the pool is destroyed
+   * before `task` is due)
+   */
+  template <typename Rep, typename Period, typename T>
+  auto enqueue_after(std::chrono::duration<Rep, Period> delay, T task)
+      -> std::future<decltype(task())> {
+    return enqueue_at(TimerWheel::Clock::now() + delay, std::move(task));
+  }
+
+  /**
+   * @brief `enqueue(task)` once `time` has passed
+   *        (other clocks than `steady_clock` are converted at the call)
+   *
+   * @tparam Clock
+   * @tparam Duration
+   * @tparam T
+   * @param time
+   * @param task
+   * @return std::future<decltype(task())>
+   */
+  template <typename Clock, typename Duration, typename T>
+  auto enqueue_at(std::chrono::time_point<Clock, Duration> time, T task)
+      -> std::future<decltype(task())> {
+    std::packaged_task<decltype(task())()> wrapper{std::move(task)};
+    auto future = wrapper.get_future();
+    TimerWheel::Clock::time_point due{};
+    if constexpr (std::is_same_v<Clock, TimerWheel::Clock>) {
+      due = std::chrono::time_point_cast<TimerWheel::Clock::duration>(time);
+    } else {
+      due = TimerWheel::Clock::now() +
+            std::chrono::duration_cast<TimerWheel::Clock::duration>(
+                time - Clock::now());
+    }
+    schedule_timer(due, [this, wrapper = std::move(wrapper)]() mutable {
+      push_task(std::move(wrapper));
+    });
+    return future;
+  }
+
+  /**
+   * @brief run `task` every `period` (first run after one period) until
+   *        the returned handle is cancelled or the pool is destroyed
+   *
+   *        Fixed rate: a run which is late does not shift the following
+   *        ones, and a run due while the previous one is still queued or
+   *        running is skipped (runs never overlap).
+   *
+   * @attention Just like `submit_detached()`, an exception escaping `task`
+   * calls `std::terminate()`.
+   *
+   * @tparam Rep
+   * @tparam Period
+   * @tparam T
+   * @param period
+   * @param task
+   * @return TimerHandle
+   */
+  template <typename Rep, typename Period, typename T>
+  TimerHandle enqueue_every(std::chrono::duration<Rep, Period> period, T task) {
+    auto interval =
+        std::chrono::duration_cast<TimerWheel::Clock::duration>(period);
+    if (interval <= TimerWheel::Clock::duration::zero()) [[unlikely]] {
+      throw std::invalid_argument("enqueue_every needs a positive period");
+    }
+    auto state = std::make_shared<Periodic<T>>(
+        std::move(task), TimerWheel::Clock::now() + interval, interval);
+    auto handle = state->handle;
+    arm_periodic(std::move(state));
+    return handle;
+  }
+
+  /**
+   * @brief enqueue every callable of `range` at once
+   *        (one queue lock and one round of wake-ups for the whole batch)
+   *
+   * @tparam Range
+   * @param range
+   * @return std::vector<std::future<...>> in the order of `range`
+   */
+  template <std::ranges::input_range Range>
+  auto enqueue_bulk(Range &&range) {
+    using Func = std::ranges::range_value_t<Range>;
+    using Ret = std::invoke_result_t<Func &>;
+    std::vector<std::future<Ret>> futures{};
+    std::vector<Task> batch{};
+    if constexpr (std::ranges::sized_range<Range>) {
+      futures.reserve(std::ranges::size(range));
+      batch.reserve(std::ranges::size(range));
+    }
+    for (auto &&task : range) [[likely]] {
+      std::packaged_task<Ret()> wrapper{[&]() -> Func {
+        if constexpr (std::is_rvalue_reference_v<Range &&>) {
+          return std::move(task);
+        } else {
+          return task;
+        }
+      }()};
+      futures.emplace_back(wrapper.get_future());
+      batch.emplace_back(std::move(wrapper));
+    }
+    push_tasks(std::move(batch));
+    return futures;
+  }
+
+  /**
+   * @brief enqueue `generator(0), generator(1), ..., generator(count - 1)`
+   *        at once (each `generator(i)` returns the i-th callable)
+   *
+   * @tparam Generator
+   * @param count
+   * @param generator
+   * @return std::vector<std::future<...>> indexed by `i`
+   */
+  template <typename Generator>
+  auto enqueue_n(std::size_t count, Generator generator) {
+    using Func = std::invoke_result_t<Generator &, std::size_t>;
+    using Ret = std::invoke_result_t<Func &>;
+    std::vector<std::future<Ret>> futures{};
+    std::vector<Task> batch{};
+    futures.reserve(count);
+    batch.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) [[likely]] {
+      std::packaged_task<Ret()> wrapper{generator(i)};
+      futures.emplace_back(wrapper.get_future());
+      batch.emplace_back(std::move(wrapper));
+    }
+    push_tasks(std::move(batch));
+    return futures;
+  }
+
+  /**
+   * @brief submit `task` and get an `Eden::Future` of its result
+   *
+   *        Allocation-free for small tasks: the task and its `Promise` live
+   *        inside the queued `UniqueTask`, and the shared state is recycled
+   *        by a thread-local pool. The future is bound to this pool, so its
+   *        `then()` continuations are scheduled here (and the pool must
+   *        outlive them, see `executor()`).
+   *
+   * @tparam T
+   * @param task
+   * @return Future<std::invoke_result_t<T &>>
+   */
+  template <typename T>
+  auto submit(T task) -> Future<std::invoke_result_t<T &>> {
+    Promise<std::invoke_result_t<T &>> promise{};
+    auto future = promise.get_future();
+    push_task([promise = std::move(promise), task = std::move(task)]() mutable {
+      promise.set_result_of(task);
+    });
+    return std::move(future).via(executor());
+  }
+
+  /**
+   * @brief `submit(task)` with a priority (see `enqueue(priority, task)`)
+   *
+   * @tparam T
+   * @param priority
+   * @param task
+   * @return Future<std::invoke_result_t<T &>>
+   */
+  template <typename T>
+  auto submit(TaskPriority priority, T task)
+      -> Future<std::invoke_result_t<T &>> {
+    Promise<std::invoke_result_t<T &>> promise{};
+    auto future = promise.get_future();
+    push_task(
+        [promise = std::move(promise), task = std::move(task)]() mutable {
+          promise.set_result_of(task);
+        },
+        priority);
+    return std::move(future).via(executor());
+  }
+
+  /**
+   * @brief `submit(task)` with a hint to run `task` on NUMA node `node`
+   *        (near its data) => ignored unless the placement is `numa_spread`
+   *
+   * @tparam T
+   * @param node
+   * @param task
+   * @return Future<std::invoke_result_t<T &>>
+   */
+  template <typename T>
+  auto submit_on(std::size_t node, T task)
+      -> Future<std::invoke_result_t<T &>> {
+    Promise<std::invoke_result_t<T &>> promise{};
+    auto future = promise.get_future();
+    push_task_on(node,
+                 [promise = std::move(promise), task = std::move(task)]() mutable {
+                   promise.set_result_of(task);
+                 });
+    return std::move(future).via(executor());
+  }
+
+  /**
+   * @brief submit `task` without any way to get its result
+   *
+   * @attention Just like `std::thread`, an exception escaping `task` calls
+   * `std::terminate()`.
+   *
+   * @tparam T
+   * @param task
+   */
+  template <typename T>
+  void submit_detached(T task) {
+    push_task([task = std::move(task)]() mutable noexcept { task(); });
+  }
+
+  /**
+   * @brief a handle posting tasks to this pool
+   *        (e.g. for `Future::via()`, to chain any future on this pool)
+   *
+   * @attention The pool must outlive the handle, and so must outlive every
+   * future bound to it whose continuation is still to be scheduled. Once
+   * the pool is shut down (but not yet destroyed), it refuses such a
+   * continuation, and the chained future reports `broken_promise`.
+   *
+   * @return ExecutorRef
+   */
+  [[nodiscard]] ExecutorRef executor() noexcept {
+    return {this, [](void *pool, UniqueTask task) {
+              static_cast<ThreadPool *>(pool)->push_task(std::move(task));
+            }};
+  }
+
+  /**
+   * @brief awaitable returned by `schedule()`
+   *
+   */
+  class ScheduleAwaiter {
+   public:
+    explicit ScheduleAwaiter(ThreadPool &pool) : pool(pool) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      pool.push_task([handle]() { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+
+   private:
+    ThreadPool &pool;
+  };
+
+  /**
+   * @brief `co_await pool.schedule()` resumes the coroutine on a worker
+   *
+   * @code
+      Eden::task<int> work(Eden::ThreadPool &pool) {
+        co_await pool.schedule();
+        co_return heavy_computation();  // runs on a worker thread
       }
-      tasks.emplace([=]() { (*wrapper)(); });
+   * @endcode
+   *
+   * @return ScheduleAwaiter
+   */
+  [[nodiscard]] ScheduleAwaiter schedule() { return ScheduleAwaiter{*this}; }
+
+  /**
+   * @brief run one queued task on the calling thread, if there is one
+   *
+   *        The building block of waiting without blocking a worker (see
+   *        `TaskGroup::wait()`): a worker takes from its own deque first,
+   *        then steals, and any other thread takes from wherever it can.
+   *
+   * @return false <=> no task was visible
+   */
+  bool run_pending_task() {
+    Task task;
+    if (!try_take_task(task)) {
+      return false;
     }
-    // 3. notify one thread to execute the task
-    condition.notify_one();
-    // 4. return the connect future object
-    return wrapper->get_future();
+    release_slot();
+    execute(task);
+    if (currentPool == this) {
+      bump(workerMetrics[currentIndex].tasksExecuted, 1);
+    }
+    finish_task();
+    return true;
   }
 
-  ~ThreadPool() {
-    // set status to stop
-    {
-      std::unique_lock<std::mutex> lock(queueMutex);
-      stop = true;
+  /**
+   * @brief block until every task queued so far (and every task they
+   *        queue) is done, without stopping the pool
+   *
+   *        Timers not due yet (`enqueue_after()`, ...) are not waited for.
+   *
+   * @attention Throws `std::logic_error` when called from a worker of this
+   * pool (which would wait for itself), use a `TaskGroup` there.
+   *
+   */
+  void wait_idle() {
+    if (currentPool == this) [[unlikely]] {
+      throw std::logic_error("wait_idle() called from a worker of its pool");
     }
-    condition.notify_all();  // notify all threads to stop
-    // wait for all threads to stop
-    for (auto &thread : threads) [[likely]] {
-      thread.join();
+    for (auto left = unfinishedTasks.load(std::memory_order_acquire);
+         left != 0; left = unfinishedTasks.load(std::memory_order_acquire))
+        [[likely]] {
+      unfinishedTasks.wait(left, std::memory_order_acquire);
+    }
+  }
+
+  /// @brief whether the calling thread is a worker of this pool
+  [[nodiscard]] bool is_worker_thread() const noexcept {
+    return currentPool == this;
+  }
+
+  /**
+   * @brief stop accepting tasks, and return once every worker has exited
+   *        (later calls, and the destructor, do nothing)
+   *
+   *        The running tasks always finish. `drain` runs the queued ones
+   *        too, `discard` drops them, so a large backlog doesn't delay the
+   *        teardown. Either way, timers not due yet are dropped.
+   *
+   *        `discard` empties the queues as it stops the pool, so the only
+   *        tasks still run are those a worker had already dequeued.
+   *
+   * @attention Throws `std::logic_error` when called from a worker of this
+   * pool (which would wait for itself).
+   *
+   * @param mode
+   */
+  void shutdown(ShutdownMode mode = ShutdownMode::drain) {
+    std::vector<Task> dropped{};
+    stop_and_join(mode == ShutdownMode::discard ? &dropped : nullptr);
+    // (destroying them breaks their promises)
+  }
+
+  /**
+   * @brief `shutdown(discard)`, except that the queued tasks are handed
+   *        back instead of being dropped (e.g. to move them to another pool)
+   *
+   * @code
+      for (auto &task : old_pool.shutdown_and_return_pending()) {
+        new_pool.submit_detached(std::move(task));
+      }
+   * @endcode
+   *
+   * @return std::vector<UniqueTask> in no particular order (empty if the pool
+   * was already shut down)
+   */
+  std::vector<UniqueTask> shutdown_and_return_pending() {
+    std::vector<Task> taken{};
+    stop_and_join(&taken);
+    std::vector<UniqueTask> pending{};
+    pending.reserve(taken.size());
+    for (auto &task : taken) [[likely]] {
+      pending.emplace_back(std::move(task.func));
     }
+    return pending;
   }
 
+  /// @brief `shutdown(ShutdownMode::drain)` unless already shut down
+  ~ThreadPool() { shutdown(ShutdownMode::drain); }
+
   /**
    * @brief Get the number of threads in the thread pool
+   *        (elastic => the workers alive right now)
+   *
+   * @return std::size_t
+   */
+  [[nodiscard]] std::size_t threads_num() const {
+    return liveWorkers.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the number of NUMA nodes the workers are spread over
+   *        (1 unless the placement is `numa_spread`)
    *
    * @return std::size_t
    */
-  [[nodiscard]] std::size_t threads_num() const { return threads.size(); }
+  [[nodiscard]] std::size_t numa_nodes_num() const {
+    return nodeQueues.empty() ? 1 : nodeQueues.size();
+  }
+
+  /**
+   * @brief Get the NUMA node of worker `index` (0 outside `numa_spread`)
+   *
+   * @param index
+   * @return std::size_t
+   */
+  [[nodiscard]] std::size_t worker_node(std::size_t index) const {
+    return workerNodes.empty() ? 0 : workerNodes.at(index);
+  }
 
   /**
    * @brief Get the number of unused threads in the thread pool
+   *        (alive, but not running any task right now)
    *
    * @return std::size_t
    */
   [[nodiscard]] std::size_t unused_threads_num() const {
-    std::size_t unused = 0;
-    for (auto &thread : threads) [[likely]] {
-      if (thread.joinable()) [[likely]] {
-        ++unused;
-      }
-    }
-    return unused;
+    auto live = threads_num();
+    auto running = running_tasks_num();
+    return live > running ? live - running : 0;
   }
 
   /**
    * @brief Get the number of running threads in the thread pool
+   *        (those running a task right now)
    *
    * @return std::size_t
    */
   [[nodiscard]] std::size_t running_threads_num() const {
-    return threads.size() - unused_threads_num();
+    return running_tasks_num();
   }
 
   /**
-   * @brief Get the number of remaining tasks in the task queue
+   * @brief Get the number of remaining tasks in the task queue(s)
+   *        (queued, but not started yet)
    *
    * @return std::size_t
    */
-  [[nodiscard]] std::size_t remaining_tasks_num() const { return tasks.size(); }
+  [[nodiscard]] std::size_t remaining_tasks_num() const {
+    std::size_t depth = queuedTasks.load(std::memory_order_relaxed);
+    if (lockFreeTasks) {
+      return depth + lockFreeTasks->size();
+    }
+    if (workStealing) {
+      for (const auto &queue : localQueues) [[likely]] {
+        depth += queue.size();
+      }
+      for (const auto &queue : nodeQueues) [[likely]] {
+        depth += queue.size();
+      }
+    }
+    return depth;
+  }
 
   /**
-   * @brief Get the number of running tasks in the task queue
+   * @brief Get the number of tasks being run by the workers right now
    *
    * @return std::size_t
    */
   [[nodiscard]] std::size_t running_tasks_num() const {
-    return tasks.size() - remaining_tasks_num();
+    std::size_t running = 0;
+    for (std::size_t i = 0; i < workerSlots; ++i) [[likely]] {
+      running += workerMetrics[i].running.load(std::memory_order_relaxed);
+    }
+    return running;
+  }
+
+  /**
+   * @brief take a snapshot of the runtime metrics
+   *        (cheap enough to be polled, e.g. once a second)
+   *
+   * @code
+      auto before = pool.metrics();
+      // ...
+      auto after = pool.metrics();
+      std::cout << after << after.throughput_since(before) << " tasks/s\n";
+   * @endcode
+   *
+   * @return ThreadPoolMetrics
+   */
+  [[nodiscard]] ThreadPoolMetrics metrics() const {
+    ThreadPoolMetrics snapshot{};
+    snapshot.takenAt = std::chrono::steady_clock::now();
+    snapshot.liveWorkers = threads_num();
+    snapshot.queueDepth = remaining_tasks_num();
+    snapshot.timed = collectTimings;
+    snapshot.workers.resize(workerSlots);
+    for (std::size_t i = 0; i < workerSlots; ++i) [[likely]] {
+      const auto &stats = workerMetrics[i];
+      auto &worker = snapshot.workers[i];
+      worker.tasksExecuted = stats.tasksExecuted.load(std::memory_order_relaxed);
+      worker.busyTime = std::chrono::nanoseconds{
+          stats.busyNanos.load(std::memory_order_relaxed)};
+      worker.idleTime = std::chrono::nanoseconds{
+          stats.idleNanos.load(std::memory_order_relaxed)};
+      worker.steals = stats.steals.load(std::memory_order_relaxed);
+      worker.parks = stats.parks.load(std::memory_order_relaxed);
+      worker.running = stats.running.load(std::memory_order_relaxed);
+      stats.queueWait.add_to(snapshot.queueWait);
+    }
+    return snapshot;
+  }
+
+  /**
+   * @brief write the recent task / park events of every thread as Chrome
+   *        trace JSON (open it in Perfetto to see what each worker did)
+   *
+   *        Only recorded in builds defining `EDEN_THREAD_POOL_TRACE` to 1,
+   *        otherwise the trace is empty (and tracing costs nothing).
+   *
+   * @param os
+   */
+  void dump_trace(std::ostream &os) const {
+#if EDEN_THREAD_POOL_TRACE
+    tracer.dump(os);
+#else
+    os << R"({"traceEvents":[]})" << "\n";
+#endif
   }
 
   // copy constructor and copy assignment operator are deleted
@@ -168,8 +1904,9 @@ class ThreadPool {
   /// @brief a thread pool
   std::vector<std::thread> threads;
 
-  /// @brief a task queue
-  std::queue<std::function<void()>> tasks;
+  /// @brief a task queue (one FIFO per `TaskPriority`)
+  /// (work-stealing / lock-free mode: only the non-`normal` tasks)
+  MultiLevelQueue<Task, task_priority_num> tasks;
 
   /// @brief a mutex to protect the task queue
   std::mutex queueMutex;
@@ -178,7 +1915,140 @@ class ThreadPool {
   std::condition_variable condition;
 
   /// @brief a flag to indicate whether the thread pool is stopped
-  bool stop = false;
+  std::atomic<bool> stop = false;
+
+  /// @brief whether the pool runs in work-stealing mode
+  bool workStealing = false;
+
+  /// @brief structure backing the shared task queue
+  TaskQueueKind queueKind = TaskQueueKind::locked;
+
+  /// @brief capacity of `lockFreeTasks`
+  std::size_t queueCapacity = 0;
+
+  /// @brief (lock-free mode) the shared task queue
+  std::unique_ptr<MPMCQueue<Task>> lockFreeTasks;
+
+  /// @brief (work-stealing mode) one deque per worker
+  std::vector<WorkStealingDeque<Task>> localQueues;
+
+  /// @brief where the workers run
+  WorkerPlacement placement = WorkerPlacement::os;
+
+  /// @brief (`pinned` mode) the CPUs given in the options
+  std::vector<std::size_t> cpus;
+
+  /// @brief (`pinned` / `numa_spread` mode) the CPUs of every worker
+  std::vector<std::vector<std::size_t>> workerCpus;
+
+  /// @brief (`numa_spread` mode) the NUMA node of every worker
+  std::vector<std::size_t> workerNodes;
+
+  /// @brief (`numa_spread` mode) one shared deque per NUMA node
+  std::vector<WorkStealingDeque<Task>> nodeQueues;
+
+  /// @brief how idle workers wait before parking
+  IdlePolicy idle{};
+
+  /// @brief tasks queued or running (=> `wait_idle()`)
+  std::atomic<std::size_t> unfinishedTasks = 0;
+
+  /// @brief lock-free mirror of `tasks.size()` (for spinners and metrics)
+  std::atomic<std::size_t> queuedTasks = 0;
+
+  /// @brief whether workers are started / retired with the load
+  bool elastic = false;
+
+  /// @brief (elastic) bounds of `liveWorkers`
+  std::size_t minThreads = 1;
+  std::size_t maxThreads = 0;
+
+  /// @brief (elastic) growth thresholds
+  std::size_t growQueueDepth = 0;
+  std::chrono::microseconds growWaitTime{};
+
+  /// @brief (elastic) idle time after which a worker retires
+  std::chrono::milliseconds idleTimeout{};
+
+  /// @brief whether tasks are timed for `metrics()`
+  bool collectTimings = false;
+
+  /// @brief number of worker slots (`maxThreads` when elastic)
+  std::size_t workerSlots = 0;
+
+  /// @brief counters of every worker slot
+  std::unique_ptr<WorkerMetrics[]> workerMetrics;
+
+  /// @brief workers currently running `worker_loop()`
+  std::atomic<std::size_t> liveWorkers = 0;
+
+  /// @brief workers blocked on `condition` (waiting for a task)
+  std::atomic<std::size_t> idleWorkers = 0;
+
+  /// @brief (elastic) `steady_clock` ticks of the last dequeue
+  std::atomic<std::int64_t> lastDequeue = 0;
+
+  /// @brief serializes `shutdown()` calls
+  std::mutex shutdownMutex;
+
+  /// @brief whether `shutdown()` already ran
+  bool shutDown = false;
+
+  /// @brief (elastic) protects `threads` and `freeSlots` after construction
+  std::mutex threadsMutex;
+
+  /// @brief (elastic) slots of `threads` whose worker has exited
+  std::vector<std::size_t> freeSlots;
+
+  /// @brief resolution of `timers`
+  std::chrono::microseconds timerTick{};
+
+  /// @brief delayed / periodic tasks (created by the first timer)
+  std::unique_ptr<TimerWheel> timers;
+
+  /// @brief protects `timers` and `timerStop`
+  std::mutex timerMutex;
+
+  /// @brief wakes the timer thread (new timer, or stop)
+  std::condition_variable timerCondition;
+
+  /// @brief drives `timers` (started with them)
+  std::thread timerThread;
+
+  /// @brief tells the timer thread to exit
+  bool timerStop = false;
+
+#if EDEN_THREAD_POOL_TRACE
+  /// @brief per-thread rings of trace events
+  TaskTracer tracer;
+#endif
+
+  /// @brief what to do with a task submitted while the queue is full
+  OverflowPolicy overflow = OverflowPolicy::block;
+
+  /// @brief (bounded) most tasks queued at once (`0` => unbounded)
+  std::size_t maxQueuedTasks = 0;
+
+  /// @brief (bounded) queue slots taken (tasks admitted, not started yet)
+  std::atomic<std::size_t> queuedSlots = 0;
+
+  /// @brief (bounded) producers waiting in `wait_for_slot()`
+  std::atomic<std::size_t> blockedProducers = 0;
+
+  /// @brief (work-stealing mode) round-robin cursor for external submissions
+  std::atomic<std::size_t> nextQueue = 0;
+
+  /// @brief (work-stealing / lock-free mode) workers parked on `condition`
+  std::atomic<std::size_t> sleepingWorkers = 0;
+
+  /// @brief the pool the current thread works for (`nullptr` if none)
+  static inline thread_local ThreadPool *currentPool = nullptr;
+
+  /// @brief the pool whose timer thread this is (if it is one)
+  static inline thread_local ThreadPool *timerPool = nullptr;
+
+  /// @brief index of the current thread in `currentPool`
+  static inline thread_local std::size_t currentIndex = 0;
 };
 
 }  // namespace Eden
\ No newline at end of file
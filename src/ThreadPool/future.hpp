@@ -0,0 +1,848 @@
+/**
+ * @file future.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief light-weight `Future` / `Promise` with pooled shared state
+ * @version 0.1
+ * @date 2023-02-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "unique_task.hpp"
+
+namespace Eden {
+
+/**
+ * @brief non-owning handle of something which runs `UniqueTask`s
+ *        (e.g. `ThreadPool::executor()`)
+ *
+ *        An empty handle runs the task right away on the calling thread.
+ *
+ * @attention Like a reference, it dangles once its executor is destroyed,
+ * and nothing tells it so: a continuation firing later would post into
+ * freed memory. An executor which is only shut down is fine, since it
+ * refuses the task, and the chained future reports `broken_promise`.
+ *
+ */
+struct ExecutorRef {
+  void *context = nullptr;
+  void (*post)(void *context, UniqueTask task) = nullptr;
+
+  /// @brief whether the handle refers to an executor
+  explicit operator bool() const noexcept { return post != nullptr; }
+
+  /// @brief hand `task` over to the executor (or run it inline)
+  void operator()(UniqueTask task) const {
+    if (post != nullptr) [[likely]] {
+      post(context, std::move(task));
+    } else {
+      task();
+    }
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief Thread-local free lists of small fixed-size blocks, balanced
+ *        through a shared depot.
+ *
+ *        A block goes back to the list of the thread that frees it. That is
+ *        often not the thread which allocated it (e.g. a worker dropping
+ *        the last reference to a state), so a list holding more than
+ *        `local_cached` blocks hands `batch_size` of them over to the depot,
+ *        and an empty list takes a batch from there before reaching the
+ *        global allocator. Once warm, a steady `submit -> get` loop never
+ *        reaches `operator new`, whichever thread frees the states.
+ *
+ */
+class StatePool {
+ public:
+  /// @brief blocks are handed out in multiples of this size
+  static constexpr std::size_t granularity = 64;
+
+  /// @brief number of size classes (bigger requests use `operator new`)
+  static constexpr std::size_t class_num = 4;
+
+  /// @brief blocks moved between a thread and the depot at once
+  static constexpr std::size_t batch_size = 32;
+
+  /// @brief at most this many blocks are cached per thread and size class
+  static constexpr std::size_t local_cached = 2 * batch_size;
+
+  /// @brief at most this many batches wait in the depot per size class
+  static constexpr std::size_t max_batches = 32;
+
+  static void *allocate(std::size_t size) {
+    auto idx = class_of(size);
+    if (idx >= class_num) [[unlikely]] {
+      return ::operator new(size);
+    }
+    auto &lists = local_lists();
+    if (lists.heads[idx] == nullptr) [[unlikely]] {
+      lists.counts[idx] = depot().take(idx, lists.heads[idx]);
+    }
+    if (Node *node = lists.heads[idx]; node != nullptr) [[likely]] {
+      lists.heads[idx] = node->next;
+      --lists.counts[idx];
+      return node;
+    }
+    ++lists.heapAllocations;
+    return ::operator new((idx + 1) * granularity);
+  }
+
+  static void deallocate(void *ptr, std::size_t size) noexcept {
+    auto idx = class_of(size);
+    if (idx >= class_num) [[unlikely]] {
+      ::operator delete(ptr);
+      return;
+    }
+    auto &lists = local_lists();
+    lists.heads[idx] = ::new (ptr) Node{lists.heads[idx]};
+    if (++lists.counts[idx] > local_cached) [[unlikely]] {
+      // hand the oldest ones over (the newest are the warmest)
+      auto *last = lists.heads[idx];
+      for (std::size_t i = 1; i < local_cached - batch_size; ++i) {
+        last = last->next;
+      }
+      depot().give(idx, std::exchange(last->next, nullptr),
+                   lists.counts[idx] - (local_cached - batch_size));
+      lists.counts[idx] = local_cached - batch_size;
+    }
+  }
+
+  /// @brief (for tests and tuning) blocks the calling thread got from
+  ///        `operator new` so far (bigger requests excluded)
+  static std::size_t heap_allocations() noexcept {
+    return local_lists().heapAllocations;
+  }
+
+ private:
+  struct Node {
+    Node *next;
+  };
+
+  static void free_list(Node *head) noexcept {
+    while (head != nullptr) {
+      ::operator delete(std::exchange(head, head->next));
+    }
+  }
+
+  /// @brief batches of blocks, shared by every thread (behind a mutex,
+  ///        taken once per `batch_size` blocks)
+  class Depot {
+   public:
+    ~Depot() {
+      for (auto &batches : classes) {
+        for (auto &batch : batches) {
+          free_list(batch.head);
+        }
+      }
+    }
+
+    void give(std::size_t idx, Node *head, std::size_t count) noexcept {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &batches = classes[idx];
+        if (batches.size() < max_batches) [[likely]] {
+          batches.push_back({head, count});
+          return;
+        }
+      }
+      free_list(head);
+    }
+
+    /// @brief take a batch into `head` (left alone if none), return its size
+    std::size_t take(std::size_t idx, Node *&head) noexcept {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto &batches = classes[idx];
+      if (batches.empty()) {
+        return 0;
+      }
+      auto batch = batches.back();
+      batches.pop_back();
+      head = batch.head;
+      return batch.count;
+    }
+
+   private:
+    struct Batch {
+      Node *head;
+      std::size_t count;
+    };
+
+    std::mutex mutex{};
+    /// @brief (never reallocated: reserved for `max_batches` up front)
+    std::array<std::vector<Batch>, class_num> classes = [] {
+      std::array<std::vector<Batch>, class_num> reserved{};
+      for (auto &batches : reserved) {
+        batches.reserve(max_batches);
+      }
+      return reserved;
+    }();
+  };
+
+  struct Lists {
+    Node *heads[class_num]{};
+    std::size_t counts[class_num]{};
+    std::size_t heapAllocations = 0;
+
+    ~Lists() {
+      // (an exiting worker leaves its blocks to the others)
+      for (std::size_t idx = 0; idx < class_num; ++idx) {
+        if (heads[idx] != nullptr) {
+          depot().give(idx, heads[idx], counts[idx]);
+        }
+      }
+    }
+  };
+
+  static std::size_t class_of(std::size_t size) {
+    return (size - 1) / granularity;
+  }
+
+  static Depot &depot() {
+    static Depot shared{};
+    return shared;
+  }
+
+  static Lists &local_lists() {
+    thread_local Lists lists{};
+    return lists;
+  }
+};
+
+/**
+ * @brief shared state between one `Promise<T>` and one `Future<T>`
+ *
+ * @tparam T
+ */
+template <typename T>
+class FutureState {
+  using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+  static constexpr std::uint32_t pending = 0;
+  static constexpr std::uint32_t ready = 1;
+  /// @brief still pending, but `callback` is installed
+  static constexpr std::uint32_t chained = 2;
+
+  /// @brief whether the state could be recycled by `StatePool`
+  static constexpr bool pooled =
+      alignof(value_type) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+ public:
+  /// @brief create a state owned by the caller (one reference)
+  static FutureState *create() {
+    if constexpr (pooled) {
+      return ::new (StatePool::allocate(sizeof(FutureState))) FutureState{};
+    } else {
+      return new FutureState{};
+    }
+  }
+
+  void add_ref() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+
+  void release() noexcept {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) != 1) [[likely]] {
+      return;
+    }
+    if constexpr (pooled) {
+      this->~FutureState();
+      StatePool::deallocate(this, sizeof(FutureState));
+    } else {
+      delete this;
+    }
+  }
+
+  template <typename... Args>
+  void set_value(Args &&...args) {
+    result.template emplace<1>(std::forward<Args>(args)...);
+    mark_ready();
+  }
+
+  void set_exception(std::exception_ptr error) {
+    result.template emplace<2>(std::move(error));
+    mark_ready();
+  }
+
+  [[nodiscard]] bool is_ready() const noexcept {
+    return status.load(std::memory_order_acquire) == ready;
+  }
+
+  /// @brief block until a value (or an exception) is stored
+  void wait() const noexcept {
+    for (;;) [[unlikely]] {
+      auto current = status.load(std::memory_order_acquire);
+      if (current == ready) [[likely]] {
+        return;
+      }
+      status.wait(current, std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * @brief run `func` (which must not throw) once the result is stored
+   *        => right now if it already is, otherwise on the thread storing it
+   *
+   * @attention At most one callback could be installed.
+   *
+   * @param func
+   */
+  void on_ready(UniqueTask func) {
+    if (status.load(std::memory_order_acquire) == chained) [[unlikely]] {
+      throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    callback = std::move(func);
+    auto expected = pending;
+    if (!status.compare_exchange_strong(expected, chained,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+        [[unlikely]] {
+      // the result was stored meanwhile => nobody else will run it
+      std::exchange(callback, UniqueTask{})();
+    }
+  }
+
+  /// @brief wait, then move the value out (or rethrow the exception)
+  T take() {
+    wait();
+    if (result.index() == 2) [[unlikely]] {
+      std::rethrow_exception(std::get<2>(result));
+    }
+    if constexpr (!std::is_void_v<T>) {
+      return std::move(std::get<1>(result));
+    }
+  }
+
+ private:
+  FutureState() = default;
+
+  void mark_ready() noexcept {
+    auto previous = status.exchange(ready, std::memory_order_acq_rel);
+    status.notify_all();
+    if (previous == chained) [[unlikely]] {
+      std::exchange(callback, UniqueTask{})();
+    }
+  }
+
+  /// @brief `pending`, `chained` or `ready`
+  std::atomic<std::uint32_t> status = pending;
+
+  /// @brief (`chained` only) what to run once the result is stored
+  UniqueTask callback{};
+
+  /// @brief number of `Promise` / `Future` objects referring to this state
+  std::atomic<std::uint32_t> refs = 1;
+
+  /// @brief empty / value / exception
+  std::variant<std::monostate, value_type, std::exception_ptr> result{};
+};
+
+}  // namespace detail
+
+template <typename T>
+class Future;
+
+/**
+ * @brief the writing end of a `Future<T>` (move-only, like `std::promise`)
+ *
+ *        A promise destroyed without a result breaks its future with
+ *        `std::future_errc::broken_promise`.
+ *
+ * @tparam T
+ */
+template <typename T>
+class Promise {
+  static_assert(!std::is_reference_v<T>, "Promise<T&> is not supported");
+
+ public:
+  Promise() : state(detail::FutureState<T>::create()) {}
+
+  Promise(Promise &&moved) noexcept
+      : state(std::exchange(moved.state, nullptr)),
+        retrieved(moved.retrieved) {}
+
+  Promise &operator=(Promise &&moved) noexcept {
+    if (this != &moved) [[likely]] {
+      abandon();
+      state = std::exchange(moved.state, nullptr);
+      retrieved = moved.retrieved;
+    }
+    return *this;
+  }
+
+  ~Promise() { abandon(); }
+
+  /// @brief get the connected future (only once)
+  Future<T> get_future() {
+    if (state == nullptr || retrieved) [[unlikely]] {
+      throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    retrieved = true;
+    state->add_ref();
+    return Future<T>{state};
+  }
+
+  template <typename... Args>
+  void set_value(Args &&...args) {
+    check_unsatisfied();
+    state->set_value(std::forward<Args>(args)...);
+    release();
+  }
+
+  void set_exception(std::exception_ptr error) {
+    check_unsatisfied();
+    state->set_exception(std::move(error));
+    release();
+  }
+
+  /// @brief invoke `func` and store whatever it returns (or throws)
+  template <typename F>
+  void set_result_of(F &func) noexcept {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        func();
+        set_value();
+      } else {
+        set_value(func());
+      }
+    } catch (...) {
+      set_exception(std::current_exception());
+    }
+  }
+
+  // copy constructor and copy assignment operator are deleted
+  Promise(const Promise &copied) = delete;
+  Promise &operator=(const Promise &copied) = delete;
+
+ private:
+  void check_unsatisfied() const {
+    if (state == nullptr) [[unlikely]] {
+      throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+  }
+
+  void release() noexcept { std::exchange(state, nullptr)->release(); }
+
+  void abandon() noexcept {
+    if (state != nullptr) [[unlikely]] {
+      set_exception(std::make_exception_ptr(
+          std::future_error(std::future_errc::broken_promise)));
+    }
+  }
+
+  /// @brief `nullptr` once the result is stored (or after being moved)
+  detail::FutureState<T> *state = nullptr;
+
+  /// @brief whether `get_future()` has been called
+  bool retrieved = false;
+};
+
+namespace detail {
+
+/// @brief what `Future<T>::then(func)` hands to `func`
+template <typename T, typename F>
+auto then_result() {
+  if constexpr (std::invocable<F &, Future<T>>) {
+    return std::type_identity<std::invoke_result_t<F &, Future<T>>>{};
+  } else if constexpr (std::is_void_v<T>) {
+    return std::type_identity<std::invoke_result_t<F &>>{};
+  } else {
+    return std::type_identity<std::invoke_result_t<F &, T>>{};
+  }
+}
+
+template <typename T, typename F>
+using then_result_t = typename decltype(then_result<T, F>())::type;
+
+}  // namespace detail
+
+/**
+ * @brief the reading end of a `Promise<T>` (move-only, like `std::future`)
+ *
+ *        Unlike `std::future`, its shared state is recycled through
+ *        `detail::StatePool` and waiting does not involve any mutex.
+ *
+ *        It could also be chained without blocking any thread: `then(func)`
+ *        hands `func` to the future's executor once the result is stored.
+ *        Futures from `ThreadPool::submit()` are bound to their pool, others
+ *        run their continuations inline unless `via()` binds them.
+ *
+ * @tparam T
+ */
+template <typename T>
+class Future {
+ public:
+  Future() noexcept = default;
+
+  Future(Future &&moved) noexcept
+      : state(std::exchange(moved.state, nullptr)),
+        bound(std::exchange(moved.bound, ExecutorRef{})) {}
+
+  Future &operator=(Future &&moved) noexcept {
+    if (this != &moved) [[likely]] {
+      reset();
+      state = std::exchange(moved.state, nullptr);
+      bound = std::exchange(moved.bound, ExecutorRef{});
+    }
+    return *this;
+  }
+
+  ~Future() { reset(); }
+
+  /// @brief wait for the result and return it (only once)
+  T get() {
+    if (state == nullptr) [[unlikely]] {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    struct Releaser {
+      Future *self;
+      ~Releaser() { self->reset(); }
+    } releaser{this};
+    return state->take();
+  }
+
+  /// @brief block until the result is available
+  void wait() const {
+    if (state == nullptr) [[unlikely]] {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    state->wait();
+  }
+
+  /// @brief whether the result is available (never blocks)
+  [[nodiscard]] bool is_ready() const noexcept {
+    return state != nullptr && state->is_ready();
+  }
+
+  /// @brief whether the future refers to a shared state
+  [[nodiscard]] bool valid() const noexcept { return state != nullptr; }
+
+  /// @brief the executor running the continuations of this future
+  [[nodiscard]] ExecutorRef executor() const noexcept { return bound; }
+
+  /// @brief bind the future to `executor` (continuations will run there)
+  Future via(ExecutorRef executor) && noexcept {
+    bound = executor;
+    return std::move(*this);
+  }
+
+  /**
+   * @brief run `func` (which must not throw) inline once the result is
+   *        stored => the building block of `then()` / `when_all()`
+   *
+   * @attention Only one callback (or `then()`) per future. The future itself
+   * is left valid, so the result could still be `get()` afterwards.
+   *
+   * @param func
+   */
+  void on_ready(UniqueTask func) {
+    if (state == nullptr) [[unlikely]] {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    state->on_ready(std::move(func));
+  }
+
+  /**
+   * @brief schedule `func` on the bound executor once the result is stored,
+   *        without blocking anyone in the meanwhile
+   *
+   *        `func` receives the value (`T`, or nothing for `Future<void>`),
+   *        then an exception stored in this future skips `func` and goes
+   *        straight to the returned one. If `func` accepts a `Future<T>`
+   *        instead, it receives this (ready) future and may handle the error
+   *        itself.
+   *
+   * @code
+      auto res = pool.submit([] { return 20; })
+                     .then([](int x) { return x + 1; })
+                     .then([](int x) { return 2 * x; });
+      res.get();  // 42
+   * @endcode
+   *
+   * @attention `func` is handed to the bound executor when the result is
+   * stored, so that executor must still exist then (see `ExecutorRef`). If
+   * this future may complete after its pool is destroyed, unbind it first
+   * with `via(ExecutorRef{})`.
+   *
+   * @tparam F
+   * @param func
+   * @return Future<...> bound to the same executor
+   */
+  template <typename F>
+  auto then(F func) && -> Future<detail::then_result_t<T, F>> {
+    using U = detail::then_result_t<T, F>;
+    if (state == nullptr) [[unlikely]] {
+      throw std::future_error(std::future_errc::no_state);
+    }
+    Promise<U> promise{};
+    auto next = promise.get_future().via(bound);
+    auto *input = state;
+    input->on_ready([self = std::move(*this), func = std::move(func),
+                     promise = std::move(promise)]() mutable noexcept {
+      auto executor = self.bound;
+      try {
+        executor([self = std::move(self), func = std::move(func),
+                  promise = std::move(promise)]() mutable {
+          auto call = [&]() -> U {
+            if constexpr (std::invocable<F &, Future<T>>) {
+              return std::invoke(func, std::move(self));
+            } else if constexpr (std::is_void_v<T>) {
+              self.get();
+              return std::invoke(func);
+            } else {
+              return std::invoke(func, self.get());
+            }
+          };
+          promise.set_result_of(call);
+        });
+      } catch (...) {
+        // the executor refused the task (e.g. a stopped pool) => the
+        // dropped `promise` reports `broken_promise`
+      }
+    });
+    return next;
+  }
+
+  // copy constructor and copy assignment operator are deleted
+  Future(const Future &copied) = delete;
+  Future &operator=(const Future &copied) = delete;
+
+ private:
+  friend class Promise<T>;
+
+  explicit Future(detail::FutureState<T> *state) noexcept : state(state) {}
+
+  void reset() noexcept {
+    if (state != nullptr) {
+      std::exchange(state, nullptr)->release();
+    }
+  }
+
+  detail::FutureState<T> *state = nullptr;
+
+  /// @brief where the continuations run (empty => inline)
+  ExecutorRef bound{};
+};
+
+/**
+ * @brief result of `when_any()`: which future finished first, and all of them
+ *
+ * @tparam Sequence `std::vector<Future<T>>` or `std::tuple<Future<Ts>...>`
+ */
+template <typename Sequence>
+struct WhenAnyResult {
+  std::size_t index = 0;
+  Sequence futures{};
+};
+
+namespace detail {
+
+/// @brief the executor of the first bound future in `futures`
+template <typename Sequence>
+ExecutorRef first_executor(const Sequence &futures) {
+  ExecutorRef found{};
+  std::apply(
+      [&](const auto &...future) {
+        ((found = found ? found : future.executor()), ...);
+      },
+      futures);
+  return found;
+}
+
+template <typename T>
+ExecutorRef first_executor(const std::vector<Future<T>> &futures) {
+  for (const auto &future : futures) [[likely]] {
+    if (future.executor()) {
+      return future.executor();
+    }
+  }
+  return {};
+}
+
+/// @brief call `func(index, future)` on every future of `futures`
+template <typename Sequence, typename F>
+void for_each_future(Sequence &futures, F &&func) {
+  std::apply(
+      [&](auto &...future) {
+        std::size_t index = 0;
+        (func(index++, future), ...);
+      },
+      futures);
+}
+
+template <typename T, typename F>
+void for_each_future(std::vector<Future<T>> &futures, F &&func) {
+  for (std::size_t index = 0; index < futures.size(); ++index) [[likely]] {
+    func(index, futures[index]);
+  }
+}
+
+/**
+ * @brief shared state of one `when_all()`
+ *
+ *        `pending` counts the inputs plus the registering thread, so the
+ *        sequence is only moved out once nobody iterates over it anymore.
+ *
+ */
+template <typename Sequence>
+struct WhenAllState {
+  WhenAllState(Sequence futures, std::size_t count)
+      : futures(std::move(futures)), pending(count + 1) {}
+
+  void arrive() noexcept {
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) [[unlikely]] {
+      promise.set_value(std::move(futures));
+    }
+  }
+
+  Sequence futures;
+  std::atomic<std::size_t> pending;
+  Promise<Sequence> promise{};
+};
+
+/**
+ * @brief shared state of one `when_any()`
+ *
+ *        `pending` counts the winner plus the registering thread (see
+ *        `WhenAllState`).
+ *
+ */
+template <typename Sequence>
+struct WhenAnyState {
+  explicit WhenAnyState(Sequence futures) : futures(std::move(futures)) {}
+
+  void win(std::size_t index) noexcept {
+    if (!done.exchange(true, std::memory_order_acq_rel)) [[unlikely]] {
+      winner = index;
+      arrive();
+    }
+  }
+
+  void arrive() noexcept {
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) [[unlikely]] {
+      promise.set_value(WhenAnyResult<Sequence>{winner, std::move(futures)});
+    }
+  }
+
+  Sequence futures;
+  std::atomic<bool> done = false;
+  std::size_t winner = 0;
+  std::atomic<std::size_t> pending = 2;
+  Promise<WhenAnyResult<Sequence>> promise{};
+};
+
+template <typename Sequence>
+Future<Sequence> when_all_of(Sequence futures, std::size_t count) {
+  auto executor = first_executor(futures);
+  auto shared = std::make_shared<WhenAllState<Sequence>>(std::move(futures),
+                                                         count);
+  auto result = shared->promise.get_future().via(executor);
+  for_each_future(shared->futures, [&](std::size_t, auto &future) {
+    future.on_ready([shared]() noexcept { shared->arrive(); });
+  });
+  shared->arrive();
+  return result;
+}
+
+template <typename Sequence>
+Future<WhenAnyResult<Sequence>> when_any_of(Sequence futures) {
+  auto executor = first_executor(futures);
+  auto shared = std::make_shared<WhenAnyState<Sequence>>(std::move(futures));
+  auto result = shared->promise.get_future().via(executor);
+  for_each_future(shared->futures, [&](std::size_t index, auto &future) {
+    future.on_ready([shared, index]() noexcept { shared->win(index); });
+  });
+  shared->arrive();
+  return result;
+}
+
+}  // namespace detail
+
+/**
+ * @brief a future which becomes ready once all of `futures` are
+ *        => it holds them back, each one ready (value or exception)
+ *
+ *        No thread waits meanwhile: the last input to finish completes the
+ *        result, and its continuations are scheduled as usual.
+ *
+ * @tparam Ts
+ * @param futures
+ * @return Future<std::tuple<Future<Ts>...>>
+ */
+template <typename... Ts>
+auto when_all(Future<Ts>... futures) -> Future<std::tuple<Future<Ts>...>> {
+  return detail::when_all_of(std::tuple<Future<Ts>...>{std::move(futures)...},
+                             sizeof...(Ts));
+}
+
+/**
+ * @brief (dynamic version) a future which becomes ready once all of
+ *        `futures` are
+ *
+ * @tparam T
+ * @param futures
+ * @return Future<std::vector<Future<T>>>
+ */
+template <typename T>
+auto when_all(std::vector<Future<T>> futures)
+    -> Future<std::vector<Future<T>>> {
+  auto count = futures.size();
+  return detail::when_all_of(std::move(futures), count);
+}
+
+/**
+ * @brief a future which becomes ready once any of `futures` is
+ *
+ * @attention The other futures keep their `when_any` callback, so they could
+ * still be waited on, but not chained with `then()` anymore.
+ *
+ * @tparam Ts
+ * @param futures
+ * @return Future<WhenAnyResult<std::tuple<Future<Ts>...>>>
+ */
+template <typename... Ts>
+  requires(sizeof...(Ts) > 0)
+auto when_any(Future<Ts>... futures)
+    -> Future<WhenAnyResult<std::tuple<Future<Ts>...>>> {
+  return detail::when_any_of(std::tuple<Future<Ts>...>{std::move(futures)...});
+}
+
+/**
+ * @brief (dynamic version) a future which becomes ready once any of
+ *        `futures` is (`futures` must not be empty)
+ *
+ * @tparam T
+ * @param futures
+ * @return Future<WhenAnyResult<std::vector<Future<T>>>>
+ */
+template <typename T>
+auto when_any(std::vector<Future<T>> futures)
+    -> Future<WhenAnyResult<std::vector<Future<T>>>> {
+  if (futures.empty()) [[unlikely]] {
+    throw std::invalid_argument("when_any of no future");
+  }
+  return detail::when_any_of(std::move(futures));
+}
+
+}  // namespace Eden
@@ -0,0 +1,62 @@
+/**
+ * @file idle_policy.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief how idle `ThreadPool` workers wait for work
+ * @version 0.1
+ * @date 2023-02-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Eden {
+
+/**
+ * @brief tell the CPU we are busy-waiting
+ *        (`pause` on x86, `yield` on ARM, nothing elsewhere)
+ *
+ */
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @brief What an idle worker does before it parks on the condition variable.
+ *
+ *        A parked worker costs a futex wake-up (several microseconds) to the
+ *        next submitter, so a worker first spins `spins` times with
+ *        `cpu_relax()`, then calls `std::this_thread::yield()` `yields`
+ *        times, re-checking the queues every time, and only then parks.
+ *
+ */
+struct IdlePolicy {
+  /// @brief busy-wait iterations (each one a `cpu_relax()`)
+  std::size_t spins = 0;
+
+  /// @brief `std::this_thread::yield()` iterations after spinning
+  std::size_t yields = 0;
+
+  /// @brief spin for a few dozen microseconds => bursts never hit the futex
+  static constexpr IdlePolicy low_latency() noexcept { return {1 << 12, 64}; }
+
+  /// @brief park right away => idle workers never burn any CPU
+  static constexpr IdlePolicy power_saving() noexcept { return {0, 0}; }
+};
+
+}  // namespace Eden
@@ -0,0 +1,208 @@
+/**
+ * @file metrics.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief runtime metrics of `ThreadPool` (counters, timings, histograms)
+ * @version 0.1
+ * @date 2023-02-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Eden {
+
+/**
+ * @brief Log2 histogram of durations (in nanoseconds).
+ *
+ *        Bucket `k` counts the samples in `[2^k, 2^(k+1))` ns (bucket 0 also
+ *        takes 0 ns), which is plenty for latencies and only costs one
+ *        relaxed increment per sample.
+ *
+ */
+class LatencyHistogram {
+ public:
+  /// @brief number of buckets (the last one takes everything above ~9 min)
+  static constexpr std::size_t bucket_num = 40;
+
+  /// @brief plain copy of the buckets
+  using Counts = std::array<std::uint64_t, bucket_num>;
+
+  static std::size_t bucket_of(std::uint64_t nanos) noexcept {
+    auto bucket = static_cast<std::size_t>(std::bit_width(nanos));
+    return bucket == 0 ? 0 : std::min(bucket - 1, bucket_num - 1);
+  }
+
+  void record(std::uint64_t nanos) noexcept {
+    buckets[bucket_of(nanos)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// @brief add the buckets into `counts`
+  void add_to(Counts &counts) const noexcept {
+    for (std::size_t i = 0; i < bucket_num; ++i) [[likely]] {
+      counts[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, bucket_num> buckets{};
+};
+
+/**
+ * @brief counters of one worker, written by that worker only
+ *        (one cache line each, so workers never share a line)
+ *
+ */
+struct alignas(64) WorkerMetrics {
+  /// @brief tasks run to completion
+  std::atomic<std::uint64_t> tasksExecuted = 0;
+  /// @brief (timings only) time spent running tasks
+  std::atomic<std::uint64_t> busyNanos = 0;
+  /// @brief (timings only) time spent between two tasks
+  std::atomic<std::uint64_t> idleNanos = 0;
+  /// @brief tasks taken from another worker's (or node's) deque
+  std::atomic<std::uint64_t> steals = 0;
+  /// @brief times the worker blocked on the condition variable
+  std::atomic<std::uint64_t> parks = 0;
+  /// @brief whether the worker is running a task right now
+  std::atomic<bool> running = false;
+  /// @brief (timings only) time between enqueue and start of its tasks
+  LatencyHistogram queueWait{};
+};
+
+/**
+ * @brief a snapshot of the metrics of a `ThreadPool`
+ *        (see `ThreadPool::metrics()`)
+ *
+ */
+struct ThreadPoolMetrics {
+  /// @brief plain copy of one `WorkerMetrics`
+  struct Worker {
+    std::uint64_t tasksExecuted = 0;
+    std::chrono::nanoseconds busyTime{};
+    std::chrono::nanoseconds idleTime{};
+    std::uint64_t steals = 0;
+    std::uint64_t parks = 0;
+    bool running = false;
+  };
+
+  /// @brief every worker slot ever used, by index
+  std::vector<Worker> workers{};
+
+  /// @brief workers alive when the snapshot was taken
+  std::size_t liveWorkers = 0;
+
+  /// @brief tasks queued but not started yet
+  std::size_t queueDepth = 0;
+
+  /// @brief whether the timings (busy / idle / queue wait) were collected
+  bool timed = false;
+
+  /// @brief (timed only) queue-wait latency of all workers
+  LatencyHistogram::Counts queueWait{};
+
+  /// @brief snapshot age => compute throughput from two snapshots
+  std::chrono::steady_clock::time_point takenAt{};
+
+  [[nodiscard]] std::uint64_t tasks_executed() const {
+    std::uint64_t sum = 0;
+    for (const auto &worker : workers) [[likely]] {
+      sum += worker.tasksExecuted;
+    }
+    return sum;
+  }
+
+  [[nodiscard]] std::size_t running_tasks() const {
+    return static_cast<std::size_t>(
+        std::count_if(workers.begin(), workers.end(),
+                      [](const Worker &worker) { return worker.running; }));
+  }
+
+  /**
+   * @brief upper bound of the queue-wait latency below which `ratio` of the
+   *        samples fall (e.g. `queue_wait_percentile(0.99)` for p99)
+   *
+   * @param ratio in `[0, 1]`
+   * @return std::chrono::nanoseconds (0 if nothing was sampled)
+   */
+  [[nodiscard]] std::chrono::nanoseconds queue_wait_percentile(
+      double ratio) const {
+    std::uint64_t total = 0;
+    for (auto count : queueWait) [[likely]] {
+      total += count;
+    }
+    if (total == 0) [[unlikely]] {
+      return {};
+    }
+    auto rank = static_cast<std::uint64_t>(ratio * static_cast<double>(total));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < queueWait.size(); ++i) [[likely]] {
+      seen += queueWait[i];
+      if (seen > rank || seen == total) {
+        return std::chrono::nanoseconds{std::int64_t{2} << i};
+      }
+    }
+    return {};
+  }
+
+  /// @brief tasks per second executed between `earlier` and this snapshot
+  [[nodiscard]] double throughput_since(const ThreadPoolMetrics &earlier) const {
+    std::chrono::duration<double> elapsed = takenAt - earlier.takenAt;
+    if (elapsed.count() <= 0) [[unlikely]] {
+      return 0;
+    }
+    return static_cast<double>(tasks_executed() - earlier.tasks_executed()) /
+           elapsed.count();
+  }
+
+  /// @brief dump the snapshot as human-readable text
+  friend std::ostream &operator<<(std::ostream &os,
+                                  const ThreadPoolMetrics &metrics) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    os << "workers: " << metrics.liveWorkers << " live, "
+       << metrics.running_tasks() << " running\n";
+    os << "queue depth: " << metrics.queueDepth << "\n";
+    os << "tasks executed: " << metrics.tasks_executed() << "\n";
+    for (std::size_t i = 0; i < metrics.workers.size(); ++i) [[likely]] {
+      const auto &worker = metrics.workers[i];
+      os << "  worker " << i << ": " << worker.tasksExecuted << " tasks, "
+         << worker.steals << " steals, " << worker.parks << " parks";
+      if (metrics.timed) {
+        os << ", busy " << duration_cast<microseconds>(worker.busyTime).count()
+           << "us, idle "
+           << duration_cast<microseconds>(worker.idleTime).count() << "us";
+      }
+      os << "\n";
+    }
+    if (metrics.timed) {
+      os << "queue wait: p50 <= " << metrics.queue_wait_percentile(0.5).count()
+         << "ns, p99 <= " << metrics.queue_wait_percentile(0.99).count()
+         << "ns, max <= " << metrics.queue_wait_percentile(1).count()
+         << "ns\n";
+    }
+    return os;
+  }
+
+  /// @brief dump the snapshot as human-readable text
+  [[nodiscard]] std::string to_string() const {
+    std::ostringstream oss{};
+    oss << *this;
+    return oss.str();
+  }
+};
+
+}  // namespace Eden
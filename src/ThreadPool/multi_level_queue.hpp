@@ -0,0 +1,155 @@
+/**
+ * @file multi_level_queue.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief FIFO queues by priority level, with aging
+ * @version 0.1
+ * @date 2023-02-11
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace Eden {
+
+/**
+ * @brief One FIFO per priority level (level 0 is the most urgent).
+ *
+ *        `try_pop()` serves the most urgent non-empty level, except that a
+ *        task which saw `aging` pops since it was pushed is served
+ *        first (the oldest of them), so a steady flow of urgent work never
+ *        starves the lower levels.
+ *
+ *        Not thread-safe (`ThreadPool` guards it with its queue mutex).
+ *
+ * @tparam T
+ * @tparam Levels
+ */
+template <typename T, std::size_t Levels>
+class MultiLevelQueue {
+  static_assert(Levels > 0, "MultiLevelQueue needs at least one level");
+
+ public:
+  /// @brief `aging == 0` => strict priorities (lower levels may starve)
+  explicit MultiLevelQueue(std::size_t aging = 64) : aging(aging) {}
+
+  void push(std::size_t level, T item) {
+    levels[clamp(level)].push_back({std::move(item), pops});
+    ++count;
+  }
+
+  /// @brief push `[first, last)` to `level` (moved from)
+  template <typename Iter>
+  void push_bulk(std::size_t level, Iter first, Iter last) {
+    auto &queue = levels[clamp(level)];
+    for (; first != last; ++first) [[likely]] {
+      queue.push_back({std::move(*first), pops});
+      ++count;
+    }
+  }
+
+  /**
+   * @brief pop the next item of level `0 .. lowest` (or an aged item of any
+   *        level)
+   *
+   * @param out
+   * @param lowest the least urgent level to consider (aging aside)
+   * @return false <=> nothing eligible
+   */
+  bool try_pop(T &out, std::size_t lowest = Levels - 1) {
+    if (count == 0) [[likely]] {
+      return false;
+    }
+    auto *queue = aged();
+    for (std::size_t level = 0; queue == nullptr && level <= clamp(lowest);
+         ++level) [[likely]] {
+      if (!levels[level].empty()) {
+        queue = &levels[level];
+      }
+    }
+    if (queue == nullptr) [[unlikely]] {
+      return false;
+    }
+    out = std::move(queue->front().item);
+    queue->pop_front();
+    --count;
+    ++pops;
+    return true;
+  }
+
+  /**
+   * @brief pop the oldest item of the least urgent non-empty level among
+   *        `Levels - 1 .. mostUrgent` (e.g. to shed load), aging aside
+   *
+   * @param out
+   * @param mostUrgent
+   * @return false <=> all those levels are empty
+   */
+  bool try_pop_least_urgent(T &out, std::size_t mostUrgent = 0) {
+    for (auto level = Levels; level-- > clamp(mostUrgent);) [[likely]] {
+      auto &queue = levels[level];
+      if (!queue.empty()) {
+        out = std::move(queue.front().item);
+        queue.pop_front();
+        --count;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] std::size_t size() const { return count; }
+
+  [[nodiscard]] bool empty() const { return count == 0; }
+
+  /// @brief change the aging threshold (see the constructor)
+  void set_aging(std::size_t threshold) { aging = threshold; }
+
+ private:
+  struct Entry {
+    T item;
+    /// @brief `pops` when the item was pushed
+    std::uint64_t stamp;
+  };
+
+  static std::size_t clamp(std::size_t level) {
+    return level < Levels ? level : Levels - 1;
+  }
+
+  /// @brief the level whose front waited the longest, if it reached `aging`
+  std::deque<Entry> *aged() {
+    if (aging == 0) [[unlikely]] {
+      return nullptr;
+    }
+    std::deque<Entry> *oldest = nullptr;
+    for (auto &queue : levels) [[likely]] {
+      if (!queue.empty() && pops - queue.front().stamp >= aging &&
+          (oldest == nullptr ||
+           queue.front().stamp <= oldest->front().stamp)) [[unlikely]] {
+        // (a tie goes to the less urgent level, the one which is starving)
+        oldest = &queue;
+      }
+    }
+    return oldest;
+  }
+
+  std::array<std::deque<Entry>, Levels> levels{};
+
+  /// @brief number of items over all levels
+  std::size_t count = 0;
+
+  /// @brief number of `try_pop()` served so far (the clock of aging)
+  std::uint64_t pops = 0;
+
+  /// @brief see the constructor
+  std::size_t aging;
+};
+
+}  // namespace Eden
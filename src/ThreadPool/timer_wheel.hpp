@@ -0,0 +1,207 @@
+/**
+ * @file timer_wheel.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief hierarchical timer wheel behind `ThreadPool::enqueue_after()`
+ * @version 0.1
+ * @date 2023-02-13
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "unique_task.hpp"
+
+namespace Eden {
+
+/**
+ * @brief A hierarchical timer wheel (4 levels of 256 slots).
+ *
+ *        Scheduling a timer and firing it are O(1): a timer sits in the
+ *        coarsest level matching its distance, and moves one level down each
+ *        time its slot comes around (at most 3 times), so thousands of
+ *        timers cost one bucket insertion each instead of one sleeping
+ *        thread each. Timers fire at tick resolution, never early.
+ *
+ *        Not thread-safe (`ThreadPool` guards it with its timer mutex).
+ *
+ */
+class TimerWheel {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t slot_bits = 8;
+  static constexpr std::size_t slot_num = std::size_t{1} << slot_bits;
+  static constexpr std::size_t level_num = 4;
+
+  explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds{1},
+                      Clock::time_point start = Clock::now())
+      : tick(tick), start(start) {}
+
+  /// @brief run `action` (on the thread calling `advance()`) once `due`
+  ///        has passed
+  void schedule(Clock::time_point due, UniqueTask action) {
+    auto target = tick_of(due);
+    // already due => the very next tick
+    place(Timer{std::max(target, current + 1), std::move(action)});
+    ++count;
+  }
+
+  /// @brief move every action due at `now` into `fired` (in due order)
+  void advance(Clock::time_point now, std::vector<UniqueTask> &fired) {
+    auto target = now < start ? 0 : static_cast<std::uint64_t>(
+                                        (now - start) / tick);
+    if (count == 0) [[unlikely]] {
+      current = std::max(current, target);
+      return;
+    }
+    while (current < target && count != 0) [[likely]] {
+      ++current;
+      cascade();
+      auto &slot = wheels[0][current & (slot_num - 1)];
+      count -= slot.size();
+      for (auto &timer : slot) [[likely]] {
+        fired.emplace_back(std::move(timer.action));
+      }
+      slot.clear();
+    }
+    current = std::max(current, target);
+  }
+
+  /**
+   * @brief when `advance()` should be called next
+   *        (the next non-empty tick, or the next cascade, whichever first)
+   *
+   * @return std::nullopt <=> no timer at all
+   */
+  [[nodiscard]] std::optional<Clock::time_point> next_wake() const {
+    if (count == 0) [[unlikely]] {
+      return std::nullopt;
+    }
+    for (std::uint64_t next = current + 1;; ++next) [[likely]] {
+      if ((next & (slot_num - 1)) == 0 ||
+          !wheels[0][next & (slot_num - 1)].empty()) {
+        return time_of(next);
+      }
+    }
+  }
+
+  /// @brief number of pending timers
+  [[nodiscard]] std::size_t size() const noexcept { return count; }
+
+  [[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+ private:
+  struct Timer {
+    /// @brief the tick to fire at
+    std::uint64_t due;
+    UniqueTask action;
+  };
+
+  /// @brief first tick at or after `time` (rounded up => never early)
+  [[nodiscard]] std::uint64_t tick_of(Clock::time_point time) const {
+    if (time <= start) [[unlikely]] {
+      return 0;
+    }
+    auto elapsed = time - start;
+    return static_cast<std::uint64_t>((elapsed + tick - Clock::duration{1}) /
+                                      tick);
+  }
+
+  [[nodiscard]] Clock::time_point time_of(std::uint64_t at) const {
+    return start + tick * static_cast<Clock::rep>(at);
+  }
+
+  /// @brief put `timer` into the level matching its distance from `current`
+  void place(Timer timer) {
+    auto delta = timer.due - current;
+    for (std::size_t level = 0; level < level_num; ++level) [[likely]] {
+      if (delta < (std::uint64_t{1} << (slot_bits * (level + 1)))) {
+        auto slot = (timer.due >> (slot_bits * level)) & (slot_num - 1);
+        wheels[level][slot].emplace_back(std::move(timer));
+        return;
+      }
+    }
+    overflow.emplace_back(std::move(timer));
+  }
+
+  /// @brief (on a slot boundary) move the timers of the coming block of
+  ///        every coarser level one level down, coarsest first
+  void cascade() {
+    if ((current & (slot_num - 1)) != 0) [[likely]] {
+      return;
+    }
+    std::size_t top = 1;
+    while (top < level_num &&
+           (current & ((std::uint64_t{1} << (slot_bits * (top + 1))) - 1)) ==
+               0) {
+      ++top;
+    }
+    if (top == level_num) [[unlikely]] {
+      reinsert(overflow);
+      top = level_num - 1;
+    }
+    for (std::size_t level = top; level >= 1; --level) [[likely]] {
+      reinsert(wheels[level][(current >> (slot_bits * level)) & (slot_num - 1)]);
+    }
+  }
+
+  void reinsert(std::vector<Timer> &timers) {
+    auto moved = std::move(timers);
+    timers.clear();
+    for (auto &timer : moved) [[likely]] {
+      place(std::move(timer));
+    }
+  }
+
+  /// @brief duration of one tick
+  Clock::duration tick;
+
+  /// @brief time of tick 0
+  Clock::time_point start;
+
+  /// @brief last tick processed by `advance()`
+  std::uint64_t current = 0;
+
+  /// @brief number of pending timers
+  std::size_t count = 0;
+
+  /// @brief `wheels[level][slot]`
+  std::array<std::array<std::vector<Timer>, slot_num>, level_num> wheels{};
+
+  /// @brief timers further than the wheels reach (`2^32` ticks)
+  std::vector<Timer> overflow{};
+};
+
+/**
+ * @brief handle of a periodic task (see `ThreadPool::enqueue_every()`)
+ *
+ */
+class TimerHandle {
+ public:
+  TimerHandle() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+  /// @brief stop further runs (a run already queued still happens)
+  void cancel() const noexcept { flag->store(true, std::memory_order_release); }
+
+  [[nodiscard]] bool cancelled() const noexcept {
+    return flag->load(std::memory_order_acquire);
+  }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> flag;
+};
+
+}  // namespace Eden
@@ -0,0 +1,160 @@
+/**
+ * @file topology.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief CPU / NUMA topology and thread pinning helpers of `ThreadPool`
+ * @version 0.1
+ * @date 2023-02-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace Eden {
+
+/**
+ * @brief which CPUs belong to which NUMA node
+ *
+ *        Read from `/sys/devices/system/node` on Linux, keeping only the
+ *        CPUs the calling thread may run on (see `allowed_cpus()`).
+ *        Everywhere else (or when sysfs is not mounted) the machine is seen
+ *        as one node holding every allowed CPU.
+ *
+ */
+struct CpuTopology {
+  /// @brief `nodes[n]` => CPUs of the n-th NUMA node (never empty)
+  std::vector<std::vector<std::size_t>> nodes{};
+
+  /**
+   * @brief detect the topology of the current machine
+   *
+   * @param root where the kernel lists the nodes (node ids may be sparse,
+   * so they are read from `root/online`, not counted up from 0)
+   * @return CpuTopology
+   */
+  static CpuTopology detect(
+      const std::string &root = "/sys/devices/system/node") {
+    CpuTopology topology{};
+    auto allowed = allowed_cpus();
+#if defined(__linux__)
+    for (auto node : parse_cpu_list(read_line(root + "/online"))) [[likely]] {
+      auto cpus = parse_cpu_list(
+          read_line(root + "/node" + std::to_string(node) + "/cpulist"));
+      std::erase_if(cpus, [&allowed](std::size_t cpu) {
+        return !std::binary_search(allowed.begin(), allowed.end(), cpu);
+      });
+      if (!cpus.empty()) [[likely]] {
+        topology.nodes.emplace_back(std::move(cpus));
+      }
+    }
+#else
+    (void)root;
+#endif
+    if (topology.nodes.empty()) [[unlikely]] {
+      topology.nodes.emplace_back(std::move(allowed));
+    }
+    return topology;
+  }
+
+  /**
+   * @brief the CPUs the calling thread may run on, in ascending order
+   *        (its affinity mask on Linux, else `0 .. hardware_concurrency() - 1`)
+   *
+   * @return std::vector<std::size_t> (never empty)
+   */
+  static std::vector<std::size_t> allowed_cpus() {
+    std::vector<std::size_t> cpus{};
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) [[likely]] {
+      for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) [[likely]] {
+        if (CPU_ISSET(cpu, &set)) {
+          cpus.emplace_back(cpu);
+        }
+      }
+    }
+#endif
+    if (cpus.empty()) [[unlikely]] {
+      auto count = std::max(1U, std::thread::hardware_concurrency());
+      for (std::size_t cpu = 0; cpu < count; ++cpu) [[likely]] {
+        cpus.emplace_back(cpu);
+      }
+    }
+    return cpus;
+  }
+
+  /**
+   * @brief parse a kernel CPU list (e.g. `0-3,8,10-11`)
+   *
+   * @param list
+   * @return std::vector<std::size_t>
+   */
+  static std::vector<std::size_t> parse_cpu_list(const std::string &list) {
+    std::vector<std::size_t> cpus{};
+    std::istringstream iss{list};
+    std::string range{};
+    while (std::getline(iss, range, ',')) [[likely]] {
+      if (range.empty() || range.find_first_of("0123456789") != 0) {
+        continue;
+      }
+      auto dash = range.find('-');
+      auto first = std::stoul(range.substr(0, dash));
+      auto last = dash == std::string::npos ? first
+                                            : std::stoul(range.substr(dash + 1));
+      for (auto cpu = first; cpu <= last; ++cpu) [[likely]] {
+        cpus.emplace_back(cpu);
+      }
+    }
+    return cpus;
+  }
+
+ private:
+  /// @brief first line of `path` (empty if it can't be read)
+  static std::string read_line(const std::string &path) {
+    std::ifstream file{path};
+    std::string line{};
+    std::getline(file, line);
+    return line;
+  }
+};
+
+/**
+ * @brief restrict the calling thread to `cpus`
+ *
+ * @param cpus
+ * @return false <=> unsupported on this platform, or rejected by the OS
+ */
+inline bool pin_current_thread(const std::vector<std::size_t> &cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto cpu : cpus) [[likely]] {
+    if (cpu < CPU_SETSIZE) [[likely]] {
+      CPU_SET(cpu, &set);
+    }
+  }
+  if (CPU_COUNT(&set) == 0) [[unlikely]] {
+    return false;
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+}  // namespace Eden
@@ -0,0 +1,289 @@
+/**
+ * @file trace.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief task tracing of `ThreadPool` (Chrome trace / Perfetto JSON)
+ * @version 0.1
+ * @date 2023-02-17
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief `#define EDEN_THREAD_POOL_TRACE 1` (before including
+ *        `ThreadPool.hpp`) to record every task of every `ThreadPool` for
+ *        `ThreadPool::dump_trace()`. Left at 0, tracing compiles to nothing.
+ *
+ */
+#ifndef EDEN_THREAD_POOL_TRACE
+#define EDEN_THREAD_POOL_TRACE 0
+#endif
+
+namespace Eden {
+
+/// @brief what a trace event records
+enum class TraceKind : std::uint8_t {
+  /// @brief a task was queued (on the submitting thread)
+  enqueue,
+  /// @brief a worker started a task
+  start,
+  /// @brief a worker finished a task
+  finish,
+  /// @brief a worker blocked waiting for work
+  park,
+  /// @brief a parked worker woke up
+  wake,
+};
+
+/**
+ * @brief Per-thread flight recorders of `TraceKind` events.
+ *
+ *        Every thread writes into its own ring (the last `capacity - 1`
+ *        events are kept), with relaxed stores and no lock, so tracing costs
+ *        a clock read and a few stores per event. `dump()` may run at any
+ *        time: it validates what it copied against the writers' cursors
+ *        (like a seqlock) and skips the events overwritten meanwhile.
+ *
+ */
+class TaskTracer {
+ public:
+  /// @brief `capacity` => ring size per thread (rounded up to 2^k)
+  explicit TaskTracer(std::size_t capacity = std::size_t{1} << 14)
+      : capacity(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+        id(next_tracer_id().fetch_add(1, std::memory_order_relaxed) + 1),
+        origin(std::chrono::steady_clock::now()) {}
+
+  /// @brief a fresh id to tell tasks apart (never 0)
+  std::uint64_t next_task_id() noexcept {
+    return nextTask.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  /**
+   * @brief record an event of the calling thread
+   *
+   * @param kind
+   * @param task the task id (`0` for park / wake)
+   * @param worker index of the calling worker (`-1` if not a worker), only
+   * read at the first event of the thread, to name it
+   */
+  void record(TraceKind kind, std::uint64_t task, long worker) {
+    auto &buffer = buffer_of_current_thread(worker);
+    auto index = buffer.head.load(std::memory_order_relaxed);
+    auto &slot = buffer.slots[index & (capacity - 1)];
+    // pairs with the acquire fence of `dump()`: a reader seeing the new
+    // slot sees the cursor saying it is being overwritten
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.nanos.store(elapsed_nanos(), std::memory_order_relaxed);
+    slot.event.store((static_cast<std::uint64_t>(kind) << 56) |
+                         (task & ((std::uint64_t{1} << 56) - 1)),
+                     std::memory_order_relaxed);
+    buffer.head.store(index + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief write the events kept so far as Chrome trace JSON
+   *        (open it with Perfetto, or `chrome://tracing`)
+   *
+   *        One track per thread: tasks are slices, parked time is a
+   *        "parked" slice, and an arrow links each enqueue to its start.
+   *
+   * @param os
+   */
+  void dump(std::ostream &os) const {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    os << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    bool first = true;
+    // (a part taking the stream writes itself)
+    auto put = [&os](auto &&part) {
+      if constexpr (std::is_invocable_v<decltype(part), std::ostream &>) {
+        part(os);
+      } else {
+        os << part;
+      }
+    };
+    auto emit = [&](auto &&...parts) {
+      os << (first ? "\n" : ",\n");
+      first = false;
+      (put(parts), ...);
+    };
+    for (std::size_t tid = 0; tid < buffers.size(); ++tid) [[likely]] {
+      const auto &buffer = *buffers[tid];
+      if (buffer.worker >= 0) {
+        emit(R"({"ph":"M","pid":1,"tid":)", tid,
+             R"(,"name":"thread_name","args":{"name":"worker )",
+             buffer.worker, R"("}})");
+      } else {
+        emit(R"({"ph":"M","pid":1,"tid":)", tid,
+             R"(,"name":"thread_name","args":{"name":"thread )", tid,
+             R"("}})");
+      }
+      auto end = buffer.head.load(std::memory_order_acquire);
+      auto begin = end > capacity ? end - capacity : 0;
+      std::vector<std::pair<std::uint64_t, std::uint64_t>> copied{};
+      copied.reserve(static_cast<std::size_t>(end - begin));
+      for (auto i = begin; i < end; ++i) [[likely]] {
+        const auto &slot = buffer.slots[i & (capacity - 1)];
+        copied.emplace_back(slot.nanos.load(std::memory_order_relaxed),
+                            slot.event.load(std::memory_order_relaxed));
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // slots of index <= head - capacity may have been overwritten
+      auto head = buffer.head.load(std::memory_order_relaxed);
+      auto valid = head >= capacity ? head - capacity + 1 : 0;
+      for (auto i = std::max(begin, valid); i < end; ++i) [[likely]] {
+        auto [nanos, event] = copied[static_cast<std::size_t>(i - begin)];
+        auto kind = static_cast<TraceKind>(event >> 56);
+        auto task = event & ((std::uint64_t{1} << 56) - 1);
+        // microseconds, with the nanoseconds as decimals
+        auto ts = [nanos = nanos](std::ostream &out) -> std::ostream & {
+          out << nanos / 1000 << '.';
+          auto rest = nanos % 1000;
+          return out << (rest < 100 ? "0" : "") << (rest < 10 ? "0" : "")
+                     << rest;
+        };
+        auto at = [&](std::ostream &out) -> std::ostream & {
+          out << R"("pid":1,"tid":)" << tid << R"(,"ts":)";
+          return ts(out);
+        };
+        switch (kind) {
+          case TraceKind::enqueue:
+            emit(R"({"ph":"i","s":"t","name":"enqueue",)", at,
+                 R"(,"args":{"task":)", task, "}}");
+            emit(R"({"ph":"s","cat":"task","name":"task","id":)", task, ",",
+                 at, "}");
+            break;
+          case TraceKind::start:
+            emit(R"({"ph":"B","cat":"task","name":"task",)", at,
+                 R"(,"args":{"task":)", task, "}}");
+            emit(R"({"ph":"f","bp":"e","cat":"task","name":"task","id":)",
+                 task, ",", at, "}");
+            break;
+          case TraceKind::finish:
+            emit(R"({"ph":"E",)", at, "}");
+            break;
+          case TraceKind::park:
+            emit(R"({"ph":"B","cat":"idle","name":"parked",)", at, "}");
+            break;
+          case TraceKind::wake:
+            emit(R"({"ph":"E",)", at, "}");
+            break;
+        }
+      }
+    }
+    os << "\n]}\n";
+  }
+
+  // copy constructor and copy assignment operator are deleted
+  TaskTracer(const TaskTracer &copied) = delete;
+  TaskTracer &operator=(const TaskTracer &copied) = delete;
+
+ private:
+  struct Slot {
+    /// @brief nanoseconds since `origin`
+    std::atomic<std::uint64_t> nanos = 0;
+    /// @brief `TraceKind` in the top 8 bits, task id below
+    std::atomic<std::uint64_t> event = 0;
+  };
+
+  struct Buffer {
+    Buffer(std::size_t capacity, long worker)
+        : slots(std::make_unique<Slot[]>(capacity)),
+          owner(std::this_thread::get_id()),
+          worker(worker) {}
+
+    std::unique_ptr<Slot[]> slots;
+    /// @brief events written so far (by the owning thread only)
+    std::atomic<std::uint64_t> head = 0;
+    /// @brief the thread writing into it
+    std::thread::id owner;
+    /// @brief worker index of the owning thread (`-1` if not a worker)
+    long worker;
+  };
+
+  /// @brief the tracer ids handed out so far
+  ///        (thread-local caches compare ids, never dangling pointers)
+  static std::atomic<std::uint64_t> &next_tracer_id() {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter;
+  }
+
+  /**
+   * @brief the ring of the calling thread (registered on first use)
+   *
+   *        A few thread-local slots remember the rings of the tracers this
+   *        thread recorded to lately (a thread may alternate between pools);
+   *        on a miss, the ring is looked up by thread id, so each thread owns
+   *        at most one ring per tracer.
+   *
+   */
+  Buffer &buffer_of_current_thread(long worker) {
+    struct CachedBuffer {
+      std::uint64_t tracer = 0;
+      Buffer *buffer = nullptr;
+    };
+    thread_local std::array<CachedBuffer, 4> cached{};
+    thread_local std::size_t nextCached = 0;
+    for (const auto &[tracer, buffer] : cached) [[likely]] {
+      if (tracer == id) [[likely]] {
+        return *buffer;
+      }
+    }
+    auto self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    auto found = std::find_if(
+        buffers.begin(), buffers.end(),
+        [self](const auto &buffer) { return buffer->owner == self; });
+    Buffer *buffer = nullptr;
+    if (found != buffers.end()) {
+      buffer = found->get();
+    } else {
+      buffer = buffers.emplace_back(std::make_unique<Buffer>(capacity, worker))
+                   .get();
+    }
+    cached[nextCached++ % cached.size()] = {id, buffer};
+    return *buffer;
+  }
+
+  [[nodiscard]] std::uint64_t elapsed_nanos() const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin)
+            .count());
+  }
+
+  /// @brief events kept per thread (a power of two)
+  std::size_t capacity;
+
+  /// @brief unique among all tracers ever created
+  std::uint64_t id;
+
+  /// @brief time 0 of the trace
+  std::chrono::steady_clock::time_point origin;
+
+  std::atomic<std::uint64_t> nextTask = 0;
+
+  /// @brief protects `buffers` (taken once per thread, and by `dump()`)
+  mutable std::mutex buffersMutex;
+
+  /// @brief one ring per thread which recorded an event
+  std::vector<std::unique_ptr<Buffer>> buffers{};
+};
+
+}  // namespace Eden
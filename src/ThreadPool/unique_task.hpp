@@ -0,0 +1,138 @@
+/**
+ * @file unique_task.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief move-only `void()` callable with small-buffer storage
+ * @version 0.1
+ * @date 2023-02-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Eden {
+
+/**
+ * @brief A move-only `void()` callable (the task type of `ThreadPool`).
+ *
+ *        Unlike `std::function`, it accepts move-only callables (e.g. lambdas
+ *        owning a `Promise`) and keeps everything up to `inline_size` bytes
+ *        inside the object, so wrapping a small lambda never allocates.
+ *        Bigger callables (or callables that may throw when moved) are put on
+ *        the heap.
+ *
+ */
+class UniqueTask {
+ public:
+  /// @brief callables up to this size are stored without allocation
+  static constexpr std::size_t inline_size = 48;
+
+  /// @brief whether `F` is stored inline
+  template <typename F>
+  static constexpr bool stored_inline =
+      sizeof(F) <= inline_size && alignof(F) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<F>;
+
+  UniqueTask() noexcept = default;
+
+  /// @brief wrap a callable (implicit, just like `std::function`)
+  template <typename F>
+    requires(!std::same_as<std::decay_t<F>, UniqueTask> &&
+             std::invocable<std::decay_t<F> &>)
+  UniqueTask(F &&func) {  // NOLINT(google-explicit-constructor)
+    using Fn = std::decay_t<F>;
+    if constexpr (stored_inline<Fn>) {
+      ::new (static_cast<void *>(storage)) Fn(std::forward<F>(func));
+      ops = &inline_ops<Fn>;
+    } else {
+      ::new (static_cast<void *>(storage)) Fn *(new Fn(std::forward<F>(func)));
+      ops = &heap_ops<Fn>;
+      ++heapAllocations;
+    }
+  }
+
+  UniqueTask(UniqueTask &&moved) noexcept { take(moved); }
+
+  UniqueTask &operator=(UniqueTask &&moved) noexcept {
+    if (this != &moved) [[likely]] {
+      reset();
+      take(moved);
+    }
+    return *this;
+  }
+
+  ~UniqueTask() { reset(); }
+
+  /// @brief invoke the wrapped callable (must not be empty)
+  void operator()() { ops->invoke(storage); }
+
+  /// @brief whether a callable is wrapped
+  explicit operator bool() const noexcept { return ops != nullptr; }
+
+  /// @brief (for tests and tuning) callables the calling thread put on the
+  ///        heap so far (those not `stored_inline`)
+  static std::size_t heap_allocations() noexcept { return heapAllocations; }
+
+  /// @brief destroy the wrapped callable (if any)
+  void reset() noexcept {
+    if (ops != nullptr) {
+      ops->destroy(storage);
+      ops = nullptr;
+    }
+  }
+
+  // copy constructor and copy assignment operator are deleted
+  UniqueTask(const UniqueTask &copied) = delete;
+  UniqueTask &operator=(const UniqueTask &copied) = delete;
+
+ private:
+  /// @brief hand-written vtable of the wrapped callable
+  struct Ops {
+    void (*invoke)(void *self);
+    void (*move)(void *from, void *to) noexcept;
+    void (*destroy)(void *self) noexcept;
+  };
+
+  template <typename Fn>
+  static constexpr Ops inline_ops{
+      [](void *self) { (*static_cast<Fn *>(self))(); },
+      [](void *from, void *to) noexcept {
+        ::new (to) Fn(std::move(*static_cast<Fn *>(from)));
+        static_cast<Fn *>(from)->~Fn();
+      },
+      [](void *self) noexcept { static_cast<Fn *>(self)->~Fn(); },
+  };
+
+  template <typename Fn>
+  static constexpr Ops heap_ops{
+      [](void *self) { (**static_cast<Fn **>(self))(); },
+      [](void *from, void *to) noexcept {
+        ::new (to) Fn *(*static_cast<Fn **>(from));
+      },
+      [](void *self) noexcept { delete *static_cast<Fn **>(self); },
+  };
+
+  void take(UniqueTask &moved) noexcept {
+    if (moved.ops != nullptr) {
+      moved.ops->move(moved.storage, storage);
+      ops = std::exchange(moved.ops, nullptr);
+    }
+  }
+
+  /// @brief inline storage of the callable (or of a pointer to it)
+  alignas(std::max_align_t) unsigned char storage[inline_size];
+
+  /// @brief `nullptr` <=> empty
+  const Ops *ops = nullptr;
+
+  static inline thread_local std::size_t heapAllocations = 0;
+};
+
+}  // namespace Eden
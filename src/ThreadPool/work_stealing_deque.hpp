@@ -0,0 +1,102 @@
+/**
+ * @file work_stealing_deque.hpp
+ * @author Eden (edwardwang33773@gmail.com)
+ * @brief per-worker task deque used by the work-stealing scheduler
+ * @version 0.1
+ * @date 2023-02-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+namespace Eden {
+
+/**
+ * @brief A deque owned by exactly one worker.
+ *
+ *        The owner pushes and pops at the back (LIFO, cache friendly), while
+ *        thieves take from the front (FIFO, the oldest and usually the
+ *        biggest piece of work). Every deque has its own lock, so the owner
+ *        only ever competes with the occasional thief instead of with the
+ *        whole pool.
+ *
+ * @tparam T
+ */
+template <typename T>
+class alignas(64) WorkStealingDeque {
+ public:
+  /// @brief push `item` to the back (owner side)
+  void push(T item) {
+    std::lock_guard<std::mutex> lock(mutex);
+    items.push_back(std::move(item));
+    count.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  /// @brief move `[first, last)` to the back under one lock acquisition
+  template <typename Iter>
+  void push_bulk(Iter first, Iter last) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto before = items.size();
+    items.insert(items.end(), std::make_move_iterator(first),
+                 std::make_move_iterator(last));
+    count.fetch_add(items.size() - before, std::memory_order_seq_cst);
+  }
+
+  /// @brief pop an item from the back (owner side)
+  bool try_pop(T &out) {
+    if (empty()) [[likely]] {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (items.empty()) [[unlikely]] {
+      return false;
+    }
+    out = std::move(items.back());
+    items.pop_back();
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// @brief steal an item from the front (thief side, never blocks)
+  bool try_steal(T &out) {
+    if (empty()) [[likely]] {
+      return false;
+    }
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock() || items.empty()) [[unlikely]] {
+      return false;
+    }
+    out = std::move(items.front());
+    items.pop_front();
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// @brief approximate number of items (exact when nobody is pushing/popping)
+  [[nodiscard]] std::size_t size() const {
+    return count.load(std::memory_order_seq_cst);
+  }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+ private:
+  /// @brief items in the deque
+  std::deque<T> items;
+
+  /// @brief a mutex to protect `items`
+  std::mutex mutex;
+
+  /// @brief lock-free mirror of `items.size()`
+  std::atomic<std::size_t> count{0};
+};
+
+}  // namespace Eden
@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "../Concepts.hpp"
+#include "../Format/format_buffer.hpp"
 
 namespace Eden {
 
@@ -102,6 +103,26 @@ constexpr auto tuple_to_pair(const std::tuple<T, U> &t) -> std::pair<T, U> {
   return std::make_pair(std::get<0>(t), std::get<1>(t));
 }
 
+/**
+ * @brief append `tuple` as `std::to_string(tuple)` returns it, e.g. to a
+ *        `memory_buffer`
+ *
+ * @tparam Args
+ * @param buffer
+ * @param tuple
+ */
+template <string_convertible... Args>
+void to_string_to(format_buffer &buffer, const std::tuple<Args...> &tuple) {
+  buffer.push_back('(');
+  for_each(tuple, [&](const auto &element, std::size_t current_index) {
+    if (current_index != 0) {
+      buffer.append(", ", ", " + 2);
+    }
+    append_to_string(buffer, element);
+  });
+  buffer.push_back(')');
+}
+
 /**
  * @brief into dyn vec
  *
@@ -169,26 +190,10 @@ constexpr std::ostream &operator<<(std::ostream &out,
  * @return std::string
  */
 template <Eden::string_convertible... Args>
-constexpr std::string to_string(const std::tuple<Args...> &tuple) {
-  std::string res;
-  res += "(";
-  Eden::for_each(tuple, [&](const auto &element, size_t current_index) {
-    if (current_index != 0) {
-      res += ", ";
-    }
-    if constexpr (Eden::could_to_string<
-                      typename std::common_type<Args...>::type>) {
-      res += std::to_string(element);
-    } else {
-      res += [&]() {
-        std::ostringstream oss;
-        oss << element;
-        return oss.str();
-      }();
-    }
-  });
-  res += ")";
-  return res;
+std::string to_string(const std::tuple<Args...> &tuple) {
+  Eden::memory_buffer<> buffer{};
+  Eden::to_string_to(buffer, tuple);
+  return Eden::to_string(buffer);
 }
 
 }  // namespace std
\ No newline at end of file
@@ -6,6 +6,17 @@ target("modern_cpp_tool_set")
     set_languages("c17", "c++20")
     add_includedirs("/usr/include", "/usr/local/include")
 
+-- ThreadPool benchmarks (not built by default)
+--   $ xmake build thread_pool_bench && xmake run thread_pool_bench --csv
+target("thread_pool_bench")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/*.cpp")
+    set_languages("c17", "c++20")
+    set_optimize("fastest")
+    add_includedirs("src", "/usr/include", "/usr/local/include")
+    add_syslinks("pthread")
+
 --
 -- If you want to known more usage about xmake, please see https://xmake.io
 --